@@ -0,0 +1,1246 @@
+// Benchmark du decodeur TIC sur PC
+//
+// Decode des captures brutes ( STX ... ETX ) comme tic_decode_task, avec les mêmes lectures
+// de DECODE_READ_SIZE bytes, et mesure le coût de l'assemblage d'une trame selon son nombre d'etiquettes.
+//
+// usage : tic_bench                                 captures de host/captures
+//         tic_bench standard|historique capture.tic ...
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "tic_types.h"
+#include "decoder.h"
+#include "dataset.h"
+#include "labels.h"
+#include "mode_detect.h"
+#include "json_writer.h"
+#include "cbor_writer.h"
+#include "tic_cbor.h"
+#include "delta.h"
+#include "energie.h"
+#include "batch.h"
+#include "stx_clock.h"
+
+#define DECODE_READ_SIZE   128      // comme decode.c
+#define MIN_DURATION_NS    500000000ULL
+
+
+// ******************* comptage des allocations ( glibc ) ******************
+static size_t s_allocs = 0;
+
+#ifdef __GLIBC__
+extern void *__libc_malloc( size_t size );
+extern void *__libc_calloc( size_t nmemb, size_t size );
+extern void *__libc_realloc( void *ptr, size_t size );
+
+void *malloc( size_t size )                 { s_allocs++; return __libc_malloc( size ); }
+void *calloc( size_t nmemb, size_t size )   { s_allocs++; return __libc_calloc( nmemb, size ); }
+void *realloc( void *ptr, size_t size )     { s_allocs++; return __libc_realloc( ptr, size ); }
+#define ALLOCS_COUNTED 1
+#else
+#define ALLOCS_COUNTED 0
+#endif
+
+
+static uint64_t now_ns( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+// ******************* trames : une seule, réutilisée ******************
+// début du contexte de chaque bench : la seule trame, réutilisée, et le nombre de trames reçues
+typedef struct {
+    tic_frame_t frame;
+    uint32_t frames;
+} frame_sink_t;
+
+// frame_alloc de tous les benchs, ctx commence par un frame_sink_t
+static tic_frame_t * frame_sink_alloc( void *ctx )
+{
+    frame_sink_t *sink = ctx;
+    frame_clear( &(sink->frame) );
+    return &(sink->frame);
+}
+
+typedef tic_error_t (*frame_ready_fn_t)( tic_frame_t *frame, void *ctx );
+
+
+typedef struct {
+    frame_sink_t fs;
+    uint32_t datasets;
+    uint32_t parse_errors;
+} bench_sink_t;
+
+// fait le travail de process_task avant publication
+static tic_error_t bench_frame_ready( tic_frame_t *frame, void *ctx )
+{
+    bench_sink_t *sink = ctx;
+    tic_data_t data;
+    if( dataset_parse( frame, &data ) != TIC_OK )
+    {
+        sink->parse_errors++;
+    }
+    sink->fs.frames++;
+    sink->datasets += dataset_count( frame );
+    return TIC_OK;
+}
+
+
+// ******************* lignes seules, sans assemblage des trames ******************
+static void bench_line( const tic_line_t *line, void *ctx )
+{
+    uint32_t *lines = ctx;
+    (*lines)++;
+}
+
+
+// ******************* decodage des captures ******************
+static char * read_file( const char *path, size_t *len )
+{
+    FILE *f = fopen( path, "rb" );
+    if( f == NULL )
+    {
+        perror( path );
+        return NULL;
+    }
+    fseek( f, 0, SEEK_END );
+    *len = ftell( f );
+    fseek( f, 0, SEEK_SET );
+    char *buf = malloc( *len );
+    if( buf && fread( buf, 1, *len, f ) != *len )
+    {
+        free( buf );
+        buf = NULL;
+    }
+    fclose( f );
+    return buf;
+}
+
+
+// remet à 0 sink ( sink_size bytes, commence par un frame_sink_t ) et lui fait recevoir les trames du mode
+static void capture_decoder_init( tic_decoder_t *td, tic_mode_t mode, void *sink, size_t sink_size, frame_ready_fn_t frame_ready )
+{
+    memset( sink, 0, sink_size );
+    const tic_decoder_io_t io = { frame_sink_alloc, frame_ready, sink };
+    decoder_init( td, &io );
+    decoder_set_mode( td, mode );
+}
+
+
+// lit la capture de path et prépare td comme capture_decoder_init(), le mode est ensuite dans td->mode
+// renvoie la capture, à libérer avec free(), NULL si erreur
+static char * capture_open( const char *mode_name, const char *path, size_t *len,
+                            tic_decoder_t *td, void *sink, size_t sink_size, frame_ready_fn_t frame_ready )
+{
+    tic_mode_t mode;
+    if( strcmp( mode_name, "standard" ) == 0 )
+        mode = TIC_MODE_STANDARD;
+    else if( strcmp( mode_name, "historique" ) == 0 )
+        mode = TIC_MODE_HISTORIQUE;
+    else
+    {
+        fprintf( stderr, "mode %s inconnu\n", mode_name );
+        return NULL;
+    }
+
+    char *buf = read_file( path, len );
+    if( buf != NULL )
+    {
+        capture_decoder_init( td, mode, sink, sink_size, frame_ready );
+    }
+    return buf;
+}
+
+
+typedef tic_error_t (*input_fn_t)( tic_decoder_t *td, const tic_char_t *buf, size_t len );
+
+static uint32_t decode_capture_with( input_fn_t input, tic_decoder_t *td, const char *buf, size_t len )
+{
+    uint32_t errors = 0;
+    for( size_t pos = 0; pos < len; pos += DECODE_READ_SIZE )
+    {
+        size_t n = ( len - pos < DECODE_READ_SIZE ) ? len - pos : DECODE_READ_SIZE;
+        if( input( td, &(buf[pos]), n ) != TIC_OK )
+        {
+            errors++;
+            decoder_reset( td );
+        }
+    }
+    return errors;
+}
+
+
+static uint32_t decode_capture( tic_decoder_t *td, const char *buf, size_t len )
+{
+    return decode_capture_with( decoder_input, td, buf, len );
+}
+
+
+// lectures d'une trame complète à chaque ETX, comme decode.c avec CONFIG_TIC_UART_FRAME_WAKEUP
+static uint32_t decode_capture_frames( tic_decoder_t *td, const char *buf, size_t len )
+{
+    uint32_t errors = 0;
+    size_t pos = 0;
+    while( pos < len )
+    {
+        const char *etx = memchr( &(buf[pos]), 0x03, len - pos );
+        size_t n = etx ? (size_t)( etx - &(buf[pos]) ) + 1 : len - pos;
+        if( decoder_input( td, &(buf[pos]), n ) != TIC_OK )
+        {
+            errors++;
+            decoder_reset( td );
+        }
+        pos += n;
+    }
+    return errors;
+}
+
+
+static int bench_capture( const char *mode_name, const char *path )
+{
+    static bench_sink_t sink;
+    static tic_decoder_t td;
+    size_t len;
+    char *buf = capture_open( mode_name, path, &len, &td, &sink, sizeof(sink), bench_frame_ready );
+    if( buf == NULL )
+    {
+        return 1;
+    }
+
+    // 1er passage hors mesure : vérifie la capture et initialise la libc ( tzset de mktime )
+    uint32_t errors = decode_capture( &td, buf, len );
+    uint32_t frames_per_pass = sink.fs.frames;
+    uint32_t datasets_per_pass = sink.datasets;
+    if( errors || sink.parse_errors || frames_per_pass == 0 )
+    {
+        fprintf( stderr, "%s : %u erreurs de decodage, %u erreurs dataset_parse, %u trames\n",
+                 path, errors, sink.parse_errors, frames_per_pass );
+        free( buf );
+        return 1;
+    }
+
+    memset( &sink, 0, sizeof(sink) );
+    size_t allocs_start = s_allocs;
+    uint64_t passes = 0;
+    uint64_t start = now_ns();
+    uint64_t elapsed;
+    do
+    {
+        decode_capture( &td, buf, len );
+        passes++;
+        elapsed = now_ns() - start;
+    } while( elapsed < MIN_DURATION_NS );
+    size_t allocs = s_allocs - allocs_start;
+
+    double bytes = (double)len * passes;
+    printf( "%-10s %7zu bytes %4u trames %3u datasets/trame : %6.2f ns/byte  %9.0f trames/s  ",
+            mode_name, len, frames_per_pass, datasets_per_pass / frames_per_pass,
+            elapsed / bytes, sink.fs.frames * 1e9 / elapsed );
+    if( ALLOCS_COUNTED )
+        printf( "%.2f allocations/trame\n", (double)allocs / sink.fs.frames );
+    else
+        printf( "allocations non comptées\n" );
+
+    // même capture un caractère à la fois : référence pour la lecture par mots
+    memset( &sink, 0, sizeof(sink) );
+    passes = 0;
+    start = now_ns();
+    do
+    {
+        decode_capture_with( decoder_input_bytewise, &td, buf, len );
+        passes++;
+        elapsed = now_ns() - start;
+    } while( elapsed < MIN_DURATION_NS );
+    printf( "%-10s octet par octet %27s : %6.2f ns/byte  %9.0f trames/s\n",
+            mode_name, "", elapsed / ((double)len * passes), sink.fs.frames * 1e9 / elapsed );
+    if( sink.fs.frames != frames_per_pass * passes || sink.parse_errors )
+    {
+        fprintf( stderr, "%s : resultats differents octet par octet\n", path );
+        free( buf );
+        return 1;
+    }
+
+    // lectures par trame complète
+    passes = 0;
+    start = now_ns();
+    do
+    {
+        decode_capture_frames( &td, buf, len );
+        passes++;
+        elapsed = now_ns() - start;
+    } while( elapsed < MIN_DURATION_NS );
+    printf( "%-10s par trame %33s : %6.2f ns/byte\n", mode_name, "", elapsed / ((double)len * passes) );
+
+    // même capture avec decoder_set_handler() seul : coût du decodage sans les trames
+    static tic_decoder_t td_lines;
+    uint32_t lines = 0;
+    const tic_decoder_handler_t handler = { NULL, bench_line, NULL, &lines };
+    decoder_init( &td_lines, NULL );
+    decoder_set_handler( &td_lines, &handler );
+    decoder_set_mode( &td_lines, td.mode );
+    passes = 0;
+    start = now_ns();
+    do
+    {
+        decode_capture( &td_lines, buf, len );
+        passes++;
+        elapsed = now_ns() - start;
+    } while( elapsed < MIN_DURATION_NS );
+    printf( "%-10s lignes seules %29s : %6.2f ns/byte  %9.0f lignes/s\n",
+            mode_name, "", elapsed / ((double)len * passes), lines * 1e9 / elapsed );
+
+    free( buf );
+    return 0;
+}
+
+
+// ******************* mode récupération ******************
+// un bit inversé dans une ligne de chaque trame, comme une liaison bruitée :
+// datasets transmis avec et sans decoder_set_salvage()
+static int bench_salvage( const char *mode_name, const char *path )
+{
+    static bench_sink_t sink;
+    static tic_decoder_t td;
+    size_t len;
+    char *buf = capture_open( mode_name, path, &len, &td, &sink, sizeof(sink), bench_frame_ready );
+    if( buf == NULL )
+    {
+        return 1;
+    }
+    tic_mode_t mode = td.mode;
+
+    // corrompt le 3e caractère après le n-ième LF de chaque trame
+    uint32_t n = 0;
+    for( size_t pos = 0, lf = 0; pos + 3 < len; pos++ )
+    {
+        if( buf[pos] == 0x02 )
+        {
+            lf = 0;
+            n++;
+        }
+        else if( buf[pos] == '\n' && ++lf == 1 + ( n % 4 ) )
+        {
+            buf[pos+3] ^= 0x01;
+        }
+    }
+
+    uint32_t datasets[2], frames[2];
+    for( int salvage = 0; salvage <= 1; salvage++ )
+    {
+        capture_decoder_init( &td, mode, &sink, sizeof(sink), bench_frame_ready );
+        decoder_set_salvage( &td, salvage );
+        decode_capture( &td, buf, len );
+        datasets[salvage] = sink.datasets;
+        frames[salvage] = sink.fs.frames;
+    }
+    printf( "%-10s 1 bit faux par trame : %3u/%u trames %5u datasets, récupération %3u trames %5u datasets\n",
+            mode_name, frames[0], n, datasets[0], frames[1], datasets[1] );
+    free( buf );
+    return ( frames[1] == n ) ? 0 : 1;
+}
+
+
+// ******************* heure des STX ******************
+// la dernière ligne d'une trame sur trois a un checksum faux : le decodeur abandonne la fin du
+// bloc, et avec elle le STX suivant. Une heure sur cinq est perdue ( queue pleine ).
+// Chaque trame publiée doit porter l'heure de son propre STX, ou 0
+#define STX_US_BASE     1000000         // heure factice : STX_US_BASE + position du STX
+
+typedef struct {
+    frame_sink_t fs;
+    const char *buf;
+    size_t len;
+    stx_time_t times[512];      // heures envoyées par uart_rcv_task
+    size_t nb_times;
+    size_t next_time;
+    size_t chunk_end;           // fin du bloc en cours de decodage
+    uint32_t unknown;           // trames sans heure
+    uint32_t wrong;             // trames avec l'heure d'un autre STX
+    int64_t last_us;
+} stx_sink_t;
+
+static bool stx_source( stx_time_t *t, void *ctx )
+{
+    stx_sink_t *sink = ctx;
+    if( sink->next_time >= sink->nb_times )
+    {
+        return false;
+    }
+    *t = sink->times[sink->next_time++];
+    return true;
+}
+
+static bool contains( const char *buf, size_t len, const char *txt, size_t txt_len )
+{
+    for( size_t i = 0; i + txt_len <= len; i++ )
+    {
+        if( memcmp( &(buf[i]), txt, txt_len ) == 0 )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// la trame est celle qui commence au STX daté : toutes ses valeurs sont entre ce STX et l'ETX suivant
+// ( les index changent à chaque trame des captures ), ETX reçu dans le bloc en cours
+static bool stx_frame_matches( const stx_sink_t *sink, const tic_frame_t *frame, size_t pos )
+{
+    if( pos >= sink->len || sink->buf[pos] != 0x02 )
+    {
+        return false;
+    }
+    const char *etx = memchr( &(sink->buf[pos]), 0x03, sink->len - pos );
+    if( etx == NULL || (size_t)( etx - sink->buf ) >= sink->chunk_end )
+    {
+        return false;
+    }
+    for( const dataset_t *ds = dataset_first( frame ); ds != NULL; ds = dataset_next( frame, ds ) )
+    {
+        if( !contains( &(sink->buf[pos]), etx - &(sink->buf[pos]), dataset_valeur( frame, ds ), ds->valeur.len ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static tic_error_t stx_frame_ready( tic_frame_t *frame, void *ctx )
+{
+    stx_sink_t *sink = ctx;
+    sink->fs.frames++;
+    if( frame->stx_us == 0 )
+    {
+        sink->unknown++;
+        return TIC_OK;
+    }
+    if( !stx_frame_matches( sink, frame, frame->stx_us - STX_US_BASE ) || frame->stx_us <= sink->last_us )
+    {
+        sink->wrong++;
+    }
+    sink->last_us = frame->stx_us;
+    return TIC_OK;
+}
+
+static int bench_stx( const char *mode_name, const char *path )
+{
+    static stx_sink_t sink;
+    static tic_decoder_t td;
+    size_t len;
+    char *buf = capture_open( mode_name, path, &len, &td, &sink, sizeof(sink), stx_frame_ready );
+    if( buf == NULL )
+    {
+        return 1;
+    }
+    sink.buf = buf;
+    sink.len = len;
+
+    // checksum faux sur la dernière ligne d'une trame sur trois, avant l'ETX et le STX suivant
+    uint32_t n = 0;
+    uint32_t corrupted = 0;
+    for( size_t pos = 0; pos < len; pos++ )
+    {
+        if( buf[pos] == 0x02 )
+        {
+            if( n++ % 5 != 4 && sink.nb_times < sizeof(sink.times) / sizeof(sink.times[0]) )
+            {
+                sink.times[sink.nb_times++] = (stx_time_t){ pos, STX_US_BASE + pos };
+            }
+        }
+        else if( buf[pos] == 0x03 && n % 3 == 0 && pos >= 2 )
+        {
+            buf[pos - 2] ^= 0x01;       // checksum de la dernière ligne, avant CR et ETX
+            corrupted++;
+        }
+    }
+
+    static stx_clock_t clock;
+    stx_clock_init( &clock );
+    decoder_set_clock( &td, stx_clock_next, &clock );
+
+    // blocs de DECODE_READ_SIZE comme tic_decode_task
+    for( size_t pos = 0; pos < len; pos += DECODE_READ_SIZE )
+    {
+        size_t nb = ( len - pos < DECODE_READ_SIZE ) ? len - pos : DECODE_READ_SIZE;
+        sink.chunk_end = pos + nb;
+        stx_clock_chunk( &clock, (const tic_char_t *)&(buf[pos]), nb, stx_source, &sink );
+        if( decoder_input( &td, &(buf[pos]), nb ) != TIC_OK )
+        {
+            decoder_reset( &td );
+        }
+    }
+    printf( "%-10s heure des STX, %u checksums faux : %3u trames, %3u sans heure, %u avec une autre heure\n",
+            mode_name, corrupted, sink.fs.frames, sink.unknown, sink.wrong );
+    free( buf );
+    return ( sink.wrong == 0 && sink.fs.frames > sink.unknown ) ? 0 : 1;
+}
+
+
+// ******************* detection du mode ******************
+// bytes nécessaires pour verrouiller le mode puis recevoir une trame complète valide,
+// en commençant la capture à différents endroits comme un branchement en cours de trame
+#define DETECT_OFFSETS   64
+
+static int bench_detect( const char *mode_name, const char *path )
+{
+    size_t len;
+    char *buf = read_file( path, &len );
+    if( buf == NULL )
+    {
+        return 1;
+    }
+    uint32_t baudrate = ( strcmp( mode_name, "standard" ) == 0 ) ? 9600 : 1200;
+    tic_mode_t attendu = ( baudrate == 9600 ) ? TIC_MODE_STANDARD : TIC_MODE_HISTORIQUE;
+
+    uint64_t lock_total = 0, frame_total = 0;
+    size_t lock_max = 0, frame_max = 0;
+    int err = 0;
+    for( size_t n = 0; n < DETECT_OFFSETS; n++ )
+    {
+        size_t start = ( len / 2 ) * n / DETECT_OFFSETS;
+        mode_detect_t md;
+        mode_detect_reset( &md );
+        size_t lock = 0, frame = 0;
+        for( size_t pos = start; pos < len && frame == 0; pos++ )
+        {
+            mode_detect_result_t res = mode_detect_input( &md, &(buf[pos]), 1 );
+            if( res == MODE_DETECT_MAUVAIS_BAUDRATE || ( res == MODE_DETECT_VERROUILLE && md.mode != attendu ) )
+            {
+                break;
+            }
+            if( res == MODE_DETECT_VERROUILLE && lock == 0 )
+                lock = pos - start + 1;
+            if( lock && md.frames_ok > 0 )
+                frame = pos - start + 1;
+        }
+        if( frame == 0 )
+        {
+            fprintf( stderr, "%s : detection ratée depuis l'offset %zu\n", path, start );
+            err = 1;
+            break;
+        }
+        lock_total += lock;
+        frame_total += frame;
+        lock_max = ( lock > lock_max ) ? lock : lock_max;
+        frame_max = ( frame > frame_max ) ? frame : frame_max;
+    }
+
+    if( err == 0 )
+    {
+        // 10 bits par byte : start + 7 bits + parité + stop
+        double ms_per_byte = 10 * 1000.0 / baudrate;
+        printf( "%-10s verrouillage %5.0f bytes %6.0f ms (max %6.0f ms)   1ère trame valide %6.0f ms (max %6.0f ms)\n",
+                mode_name, (double)lock_total / DETECT_OFFSETS, ms_per_byte * lock_total / DETECT_OFFSETS,
+                ms_per_byte * lock_max, ms_per_byte * frame_total / DETECT_OFFSETS, ms_per_byte * frame_max );
+    }
+    free( buf );
+    return err;
+}
+
+
+// ******************* serialisation JSON ******************
+// référence : l'ancien printf_ds() de process.c, un snprintf() par donnée
+static size_t json_snprintf( char *buf, size_t size, const tic_frame_t *frame )
+{
+    size_t pos = snprintf( buf, size, "\"tic\" : {\n" );
+    bool first = true;
+    for( const dataset_t *ds = dataset_first( frame ); ds && pos < size; ds = dataset_next( frame, ds ) )
+    {
+        if( (ds->flags & TIC_DS_PUBLISHED) == 0 )
+            continue;
+        if( !first )
+            pos += snprintf( &(buf[pos]), size - pos, ",\n" );
+        first = false;
+        const char *e = dataset_etiquette( frame, ds ), *h = dataset_horodate( frame, ds ), *v = dataset_valeur( frame, ds );
+        bool avec_horodate = ( ds->flags & TIC_DS_HAS_TIMESTAMP );
+        if( ds->type == TIC_TYPE_ENTIER )
+            pos += avec_horodate ? snprintf( &(buf[pos]), size - pos, "  \"%s\":{\"horodate\":\"%s\", \"val\":%d}", e, h, ds->val.entier )
+                                 : snprintf( &(buf[pos]), size - pos, "  \"%s\":{\"val\":%d}", e, ds->val.entier );
+        else
+            pos += avec_horodate ? snprintf( &(buf[pos]), size - pos, "  \"%s\":{\"horodate\":\"%s\", \"val\":\"%s\"}", e, h, v )
+                                 : snprintf( &(buf[pos]), size - pos, "  \"%s\":{\"val\":\"%s\"}", e, v );
+    }
+    if( pos < size )
+        pos += snprintf( &(buf[pos]), size - pos, first ? "}" : "\n}" );
+    return pos;
+}
+
+
+static tic_error_t json_frame_ready( tic_frame_t *frame, void *ctx )
+{
+    ((frame_sink_t *)ctx)->frames++;
+    return TIC_OK;
+}
+
+
+static int bench_json( const char *mode_name, const char *path )
+{
+    // 1ère trame de la capture
+    static frame_sink_t sink;
+    static tic_decoder_t td;
+    size_t len;
+    char *buf = capture_open( mode_name, path, &len, &td, &sink, sizeof(sink), json_frame_ready );
+    if( buf == NULL )
+    {
+        return 1;
+    }
+    const char *etx = memchr( buf, 0x03, len );
+    decoder_input( &td, buf, etx ? (size_t)( etx - buf ) + 1 : len );
+    free( buf );
+    if( sink.frames == 0 )
+    {
+        fprintf( stderr, "%s : aucune trame\n", path );
+        return 1;
+    }
+
+    static char out_ref[1500], out_jw[1500];
+    size_t len_ref = json_snprintf( out_ref, sizeof(out_ref), &(sink.frame) );
+    json_writer_t jw;
+    json_init( &jw, out_jw, sizeof(out_jw) );
+    json_write_frame( &jw, &(sink.frame) );
+    size_t len_jw;
+    if( json_finish( &jw, &len_jw ) != TIC_OK || len_jw != len_ref || memcmp( out_ref, out_jw, len_ref ) != 0 )
+    {
+        fprintf( stderr, "%s : JSON different de la référence\n%s\n%s\n", path, out_ref, out_jw );
+        return 1;
+    }
+
+    // modèle : construit au 1er passage, réutilisé au 2ème, même texte les deux fois
+    static json_template_t tpl;
+    json_template_init( &tpl );
+    for( int i = 0; i < 2; i++ )
+    {
+        json_init( &jw, out_jw, sizeof(out_jw) );
+        json_write_frame_template( &jw, &tpl, &(sink.frame) );
+        if( json_finish( &jw, &len_jw ) != TIC_OK || len_jw != len_ref || memcmp( out_ref, out_jw, len_ref ) != 0 )
+        {
+            fprintf( stderr, "%s : JSON du modèle different de la référence\n%s\n%s\n", path, out_ref, out_jw );
+            return 1;
+        }
+    }
+    if( tpl.rebuilds != 1 || tpl.hits != 1 )
+    {
+        fprintf( stderr, "%s : modèle reconstruit %u fois, réutilisé %u fois\n", path, tpl.rebuilds, tpl.hits );
+        return 1;
+    }
+
+    // zone des inconnus : une autre etiquette au même emplacement reconstruit le modèle
+    static const char *INCONNUS[] = { "ZZA", "ZZB" };
+    static tic_frame_t frame;
+    for( int i = 0; i < 2; i++ )
+    {
+        memcpy( &frame, &(sink.frame), sizeof(frame) );
+        dataset_t *ds = dataset_new( &frame, TIC_LABEL_INCONNU, INCONNUS[i], 3, NULL, 0, "42", 2 );
+        if( ds == NULL )
+        {
+            fprintf( stderr, "%s : dataset_new() erreur\n", path );
+            return 1;
+        }
+        ds->flags |= TIC_DS_PUBLISHED;
+        dataset_insert( &frame, ds );
+        len_ref = json_snprintf( out_ref, sizeof(out_ref), &frame );
+        json_init( &jw, out_jw, sizeof(out_jw) );
+        json_write_frame_template( &jw, &tpl, &frame );
+        if( json_finish( &jw, &len_jw ) != TIC_OK || len_jw != len_ref || memcmp( out_ref, out_jw, len_ref ) != 0 )
+        {
+            fprintf( stderr, "%s : JSON du modèle avec l'etiquette %s different de la référence\n%s\n%s\n",
+                     path, INCONNUS[i], out_ref, out_jw );
+            return 1;
+        }
+    }
+    len_ref = json_snprintf( out_ref, sizeof(out_ref), &(sink.frame) );
+
+    double ns[3];
+    for( int impl = 0; impl < 3; impl++ )
+    {
+        uint64_t passes = 0;
+        uint64_t start = now_ns();
+        uint64_t elapsed;
+        volatile size_t total = 0;
+        do
+        {
+            if( impl == 0 )
+            {
+                total += json_snprintf( out_ref, sizeof(out_ref), &(sink.frame) );
+            }
+            else if( impl == 2 )
+            {
+                json_init( &jw, out_jw, sizeof(out_jw) );
+                json_write_frame_template( &jw, &tpl, &(sink.frame) );
+                json_finish( &jw, &len_jw );
+                total += len_jw;
+            }
+            else
+            {
+                json_init( &jw, out_jw, sizeof(out_jw) );
+                json_write_frame( &jw, &(sink.frame) );
+                json_finish( &jw, &len_jw );
+                total += len_jw;
+            }
+            passes++;
+            elapsed = now_ns() - start;
+        } while( elapsed < MIN_DURATION_NS / 5 );
+        ns[impl] = (double)elapsed / passes;
+    }
+    printf( "%-10s JSON %4zu bytes : snprintf %7.0f ns/trame   json_writer %7.0f ns/trame   modèle %7.0f ns/trame\n",
+            mode_name, len_jw, ns[0], ns[1], ns[2] );
+    return 0;
+}
+
+
+// ******************* CBOR ******************
+// taille des payloads JSON et CBOR de toutes les trames d'une capture, avec le même entête
+// que process.c, et relecture du CBOR par le decodeur de tic_cbor.c
+#define CBOR_ESP_TIME    1767225600          // 2026-01-01T00:00:00Z
+#define CBOR_FREE_MEM    180000
+
+typedef struct {
+    frame_sink_t fs;
+    size_t json_bytes;
+    size_t cbor_bytes;
+    uint32_t errors;
+} cbor_sink_t;
+
+// même document que datasets_to_json() de process.c
+static tic_error_t json_doc( char *buf, size_t size, const tic_frame_t *frame, size_t *len )
+{
+    json_writer_t jw;
+    json_init( &jw, buf, size );
+    JSON_RAW( &jw, "{\n\"esp_time\":\"2026-01-01T01:00:00+0100\",\n\"esp_free_mem\":" );
+    json_uint( &jw, CBOR_FREE_MEM );
+    JSON_RAW( &jw, ",\n" );
+    json_write_frame( &jw, frame );
+    JSON_RAW( &jw, " }\n" );
+    return json_finish( &jw, len );
+}
+
+// 0 si le CBOR décodé contient les mêmes etiquettes et valeurs que la trame
+static int cbor_compare( const tic_cbor_frame_t *cf, const tic_frame_t *frame )
+{
+    if( cf->esp_time != CBOR_ESP_TIME || cf->esp_free_mem != CBOR_FREE_MEM || cf->incomplete != ( frame->nb_rejets > 0 ) )
+    {
+        return -1;
+    }
+    size_t i = 0;
+    for( const dataset_t *ds = dataset_first( frame ); ds != NULL; ds = dataset_next( frame, ds ) )
+    {
+        if( (ds->flags & TIC_DS_PUBLISHED) == 0 )
+        {
+            continue;
+        }
+        if( i >= cf->nb_entries )
+        {
+            return -1;
+        }
+        const tic_cbor_entry_t *e = &(cf->entries[i++]);
+        bool avec_horodate = ( ds->flags & TIC_DS_HAS_TIMESTAMP );
+        if(    strcmp( e->etiquette, dataset_etiquette( frame, ds ) ) != 0
+            || e->is_int != ( ds->type == TIC_TYPE_ENTIER )
+            || ( e->is_int && e->val != ds->val.entier )
+            || ( !e->is_int && strcmp( e->text, dataset_valeur( frame, ds ) ) != 0 )
+            || e->has_horodate != avec_horodate )
+        {
+            return -1;
+        }
+        if( avec_horodate && ( e->horodate_is_text ? strcmp( e->horodate_text, dataset_horodate( frame, ds ) ) != 0
+                                                   : e->horodate != ds->ts ) )
+        {
+            return -1;
+        }
+    }
+    return ( i == cf->nb_entries ) ? 0 : -1;
+}
+
+static tic_error_t cbor_frame_ready( tic_frame_t *frame, void *ctx )
+{
+    cbor_sink_t *sink = ctx;
+    sink->fs.frames++;
+
+    static char json[MQTT_PAYLOAD_BUFFER_SIZE];
+    size_t json_len;
+
+    static uint8_t cbor[MQTT_PAYLOAD_BUFFER_SIZE];
+    cbor_writer_t cw;
+    cbor_init( &cw, cbor, sizeof(cbor) );
+    cbor_write_frame( &cw, frame, CBOR_ESP_TIME, CBOR_FREE_MEM );
+    size_t cbor_len;
+
+    static tic_cbor_frame_t cf;
+    if(    json_doc( json, sizeof(json), frame, &json_len ) != TIC_OK || cbor_finish( &cw, &cbor_len ) != TIC_OK
+        || tic_cbor_decode( cbor, cbor_len, &cf ) != 0 || cbor_compare( &cf, frame ) != 0 )
+    {
+        sink->errors++;
+    }
+    sink->json_bytes += json_len;
+    sink->cbor_bytes += cbor_len;
+    return TIC_OK;
+}
+
+
+static int bench_cbor( const char *mode_name, const char *path )
+{
+    static cbor_sink_t sink;
+    static tic_decoder_t td;
+    size_t len;
+    char *buf = capture_open( mode_name, path, &len, &td, &sink, sizeof(sink), cbor_frame_ready );
+    if( buf == NULL )
+    {
+        return 1;
+    }
+    decoder_input( &td, buf, len );
+    free( buf );
+
+    if( sink.fs.frames == 0 || sink.errors > 0 )
+    {
+        fprintf( stderr, "%s : %u trames, %u payloads CBOR différents de la trame\n", path, sink.fs.frames, sink.errors );
+        return 1;
+    }
+    printf( "%-10s payload moyen JSON %4zu bytes   CBOR %4zu bytes (%2.0f %%)   %u trames relues\n",
+            mode_name, sink.json_bytes / sink.fs.frames, sink.cbor_bytes / sink.fs.frames,
+            100.0 * sink.cbor_bytes / sink.json_bytes, sink.fs.frames );
+
+    // doublons dans la zone des inconnus : une etiquette connue répétée et deux fois la même
+    // etiquette inconnue, chaque clé n'apparait qu'une fois dans la map
+    tic_frame_t *frame = &(sink.fs.frame);
+    const dataset_t *premier = dataset_first( frame );
+    size_t nb_cles = 1;
+    for( const dataset_t *ds = premier; ds != NULL; ds = dataset_next( frame, ds ) )
+    {
+        nb_cles += ( ds->flags & TIC_DS_PUBLISHED ) ? 1 : 0;
+    }
+    const char *doublons[] = { label_name( premier->label ), "ZZA", "ZZA" };
+    for( size_t i = 0; i < sizeof(doublons) / sizeof(doublons[0]); i++ )
+    {
+        tic_label_id_t label = ( i == 0 ) ? premier->label : TIC_LABEL_INCONNU;
+        dataset_t *ds = dataset_new( frame, label, doublons[i], strlen( doublons[i] ), NULL, 0, "42", 2 );
+        if( ds == NULL )
+        {
+            fprintf( stderr, "%s : dataset_new() erreur\n", path );
+            return 1;
+        }
+        ds->flags |= TIC_DS_PUBLISHED;
+        dataset_insert( frame, ds );
+    }
+    static uint8_t cbor[MQTT_PAYLOAD_BUFFER_SIZE];
+    static tic_cbor_frame_t cf;
+    cbor_writer_t cw;
+    cbor_init( &cw, cbor, sizeof(cbor) );
+    cbor_write_frame( &cw, frame, CBOR_ESP_TIME, CBOR_FREE_MEM );
+    size_t cbor_len;
+    if( cbor_finish( &cw, &cbor_len ) != TIC_OK || tic_cbor_decode( cbor, cbor_len, &cf ) != 0 )
+    {
+        return 1;
+    }
+    for( size_t i = 0; i < cf.nb_entries; i++ )
+    {
+        for( size_t j = 0; j < i; j++ )
+        {
+            if( strcmp( cf.entries[i].etiquette, cf.entries[j].etiquette ) == 0 )
+            {
+                fprintf( stderr, "%s : clé %s en double dans la map CBOR\n", path, cf.entries[i].etiquette );
+                return 1;
+            }
+        }
+    }
+    if( cf.nb_entries != nb_cles )
+    {
+        fprintf( stderr, "%s : %zu clés CBOR, %zu attendues\n", path, cf.nb_entries, nb_cles );
+        return 1;
+    }
+    return 0;
+}
+
+
+// ******************* publication delta ******************
+// payloads JSON complets et delta de toutes les trames d'une capture, une trame par seconde
+#define DELTA_KEYFRAME_S   60
+
+typedef struct {
+    frame_sink_t fs;
+    delta_state_t delta;
+    uint32_t labels_full;
+    size_t bytes_full;
+    size_t bytes_delta;
+    uint32_t errors;
+} delta_sink_t;
+
+static size_t delta_json_len( const tic_frame_t *frame )
+{
+    static char json[MQTT_PAYLOAD_BUFFER_SIZE];
+    json_writer_t jw;
+    json_init( &jw, json, sizeof(json) );
+    json_write_frame( &jw, frame );
+    size_t len;
+    return ( json_finish( &jw, &len ) == TIC_OK ) ? len : 0;
+}
+
+static tic_error_t delta_frame_ready( tic_frame_t *frame, void *ctx )
+{
+    delta_sink_t *sink = ctx;
+    for( const dataset_t *ds = dataset_first( frame ); ds != NULL; ds = dataset_next( frame, ds ) )
+    {
+        sink->labels_full += ( ds->flags & TIC_DS_PUBLISHED ) ? 1 : 0;
+    }
+    size_t full = delta_json_len( frame );
+    delta_filter( &(sink->delta), frame, (int64_t)sink->fs.frames * 1000000 );
+    delta_commit( &(sink->delta) );
+    size_t delta = delta_json_len( frame );
+    if( full == 0 || delta == 0 )
+    {
+        sink->errors++;
+    }
+    sink->bytes_full += full;
+    sink->bytes_delta += delta;
+    sink->fs.frames++;
+    return TIC_OK;
+}
+
+
+static int bench_delta( const char *mode_name, const char *path )
+{
+    static delta_sink_t sink;
+    static tic_decoder_t td;
+    size_t len;
+    char *buf = capture_open( mode_name, path, &len, &td, &sink, sizeof(sink), delta_frame_ready );
+    if( buf == NULL )
+    {
+        return 1;
+    }
+    delta_init( &(sink.delta), DELTA_KEYFRAME_S );
+    decoder_input( &td, buf, len );
+    free( buf );
+
+    if( sink.fs.frames == 0 || sink.errors > 0 )
+    {
+        fprintf( stderr, "%s : %u trames, %u erreurs JSON\n", path, sink.fs.frames, sink.errors );
+        return 1;
+    }
+    // etiquettes publiées : keyframes complètes + etiquettes modifiées des trames delta
+    uint32_t labels_delta = sink.labels_full - sink.delta.labels_skipped;
+    printf( "%-10s delta %u keyframes %u deltas : etiquettes %5u -> %5u   JSON %6zu -> %6zu bytes (%2.0f %%)\n",
+            mode_name, sink.delta.keyframes, sink.delta.deltas, sink.labels_full, labels_delta,
+            sink.bytes_full, sink.bytes_delta, 100.0 * sink.bytes_delta / sink.bytes_full );
+    return 0;
+}
+
+
+// ******************* puissance active ******************
+// deux index EAST reçus à 1 s d'intervalle, dans l'ordre du ring buffer de puissance.c
+static int bench_puissance( void )
+{
+    static const east_point_t POINTS[] = { { 1000000, 12345000 }, { 2000000, 12345001 } };
+    east_ring_t ring;
+    east_ring_init( &ring );
+    for( size_t i = 0; i < sizeof(POINTS) / sizeof(POINTS[0]); i++ )
+    {
+        east_ring_add( &ring, &(POINTS[i]) );
+    }
+    int32_t p1 = east_puissance( east_ring_get( &ring, 0 ), east_ring_get( &ring, 1 ) );
+    int32_t p2 = east_puissance( east_ring_get( &ring, 0 ), east_ring_get( &ring, 2 ) );
+    if( p1 != 3600 || p2 != -1 )
+    {
+        fprintf( stderr, "puissance : 1 Wh en 1 s = %"PRIi32" W ( 3600 attendus ), sans point ancien %"PRIi32" ( -1 attendu )\n", p1, p2 );
+        return 1;
+    }
+    printf( "puissance  1 Wh en 1 s : %"PRIi32" W\n", p1 );
+    return 0;
+}
+
+
+// trames non publiées ( pool vide, queue pleine ) : sans delta_commit(), une keyframe perdue est
+// recommencée, et une valeur modifiée reste publiée dans la trame suivante même si elle n'a plus changé
+static int bench_delta_perte( void )
+{
+    static const char *VALEURS[] = { "001000", "001000", "001001", "001001" };
+    static const bool PERDUE[] = { true, false, true, false };
+    static const bool KEYFRAME[] = { true, true, false, false };
+    static tic_frame_t frame;
+    static delta_state_t dt;
+    delta_init( &dt, DELTA_KEYFRAME_S );
+    for( int i = 0; i < 4; i++ )
+    {
+        frame_clear( &frame );
+        dataset_t *ds = dataset_new( &frame, TIC_LABEL_BASE, "BASE", 4, NULL, 0, VALEURS[i], 6 );
+        if( ds == NULL )
+        {
+            return 1;
+        }
+        ds->flags |= TIC_DS_PUBLISHED;
+        dataset_insert( &frame, ds );
+        if( delta_filter( &dt, &frame, (int64_t)i * 1000000 ) != KEYFRAME[i] || ( ds->flags & TIC_DS_PUBLISHED ) == 0 )
+        {
+            fprintf( stderr, "delta : trame %d après une trame perdue, BASE non publiée\n", i );
+            return 1;
+        }
+        if( !PERDUE[i] )
+        {
+            delta_commit( &dt );
+        }
+    }
+    printf( "delta      BASE republiée après une keyframe et une trame delta perdues\n" );
+    return 0;
+}
+
+
+// ******************* lots de trames ******************
+// messages et bytes publiés par lots de BATCH_MAX_FRAMES trames, une trame par seconde,
+// avec les agrégats, et relecture des lots CBOR par le decodeur de tic_cbor.c
+#define BATCH_MAX_FRAMES   10
+#define BATCH_MAX_AGE_S    15
+
+typedef struct {
+    frame_sink_t fs;
+    batch_t batches[2];             // BATCH_JSON, BATCH_CBOR
+    size_t bytes_single[2];         // un message par trame
+    size_t bytes_batch[2];
+    uint32_t relues;                // trames relues dans les lots CBOR
+    uint32_t errors;
+} batch_sink_t;
+
+static void batch_frame_relue( const tic_cbor_frame_t *cf, void *ctx )
+{
+    batch_sink_t *sink = ctx;
+    sink->relues++;
+    if( cf->esp_time != CBOR_ESP_TIME || cf->nb_entries == 0 )
+    {
+        sink->errors++;
+    }
+}
+
+static void batch_publish( batch_sink_t *sink, uint8_t format, batch_flush_t cause )
+{
+    static char payload[MQTT_PAYLOAD_BUFFER_SIZE];
+    size_t len;
+    if( batch_finish( &(sink->batches[format]), payload, sizeof(payload), &len, cause ) != TIC_OK )
+    {
+        sink->errors++;
+        return;
+    }
+    sink->bytes_batch[format] += len;
+    if( format != BATCH_CBOR )
+    {
+        return;
+    }
+
+    static tic_cbor_batch_t cb;
+    if( tic_cbor_decode_batch( (const uint8_t *)payload, len, &cb, batch_frame_relue, sink ) != 0 || cb.nb_agg == 0 )
+    {
+        sink->errors++;
+        return;
+    }
+    for( size_t i = 0; i < cb.nb_agg; i++ )
+    {
+        if( cb.agg[i].min > cb.agg[i].last || cb.agg[i].last > cb.agg[i].max )
+        {
+            sink->errors++;
+        }
+    }
+}
+
+static tic_error_t batch_frame_ready( tic_frame_t *frame, void *ctx )
+{
+    batch_sink_t *sink = ctx;
+    int64_t now_us = (int64_t)sink->fs.frames * 1000000;
+    sink->fs.frames++;
+
+    static char docs[2][MQTT_PAYLOAD_BUFFER_SIZE];
+    size_t len[2];
+    cbor_writer_t cw;
+    cbor_init( &cw, (uint8_t *)docs[BATCH_CBOR], sizeof(docs[BATCH_CBOR]) );
+    cbor_write_frame( &cw, frame, CBOR_ESP_TIME, CBOR_FREE_MEM );
+    if( json_doc( docs[BATCH_JSON], sizeof(docs[BATCH_JSON]), frame, &len[BATCH_JSON] ) != TIC_OK
+        || cbor_finish( &cw, &len[BATCH_CBOR] ) != TIC_OK )
+    {
+        sink->errors++;
+        return TIC_OK;
+    }
+
+    // même enchainement que add_to_batch() de process.c
+    for( uint8_t format = BATCH_JSON; format <= BATCH_CBOR; format++ )
+    {
+        batch_t *b = &(sink->batches[format]);
+        sink->bytes_single[format] += len[format];
+        tic_error_t err = batch_add( b, docs[format], len[format], frame, now_us );
+        if( err == TIC_ERR_OVERFLOW && !batch_is_empty( b ) )
+        {
+            batch_publish( sink, format, BATCH_FLUSH_SIZE );
+            err = batch_add( b, docs[format], len[format], frame, now_us );
+        }
+        if( err != TIC_OK )
+        {
+            sink->errors++;
+            continue;
+        }
+        batch_flush_t cause = batch_due( b, now_us, false );
+        if( cause != BATCH_FLUSH_NONE )
+        {
+            batch_publish( sink, format, cause );
+        }
+    }
+    return TIC_OK;
+}
+
+
+static int bench_batch( const char *mode_name, const char *path )
+{
+    static batch_sink_t sink;
+    static tic_decoder_t td;
+    size_t len;
+    char *buf = capture_open( mode_name, path, &len, &td, &sink, sizeof(sink), batch_frame_ready );
+    if( buf == NULL )
+    {
+        return 1;
+    }
+    batch_init( &(sink.batches[BATCH_JSON]), BATCH_JSON, BATCH_MAX_FRAMES, BATCH_MAX_AGE_S, true );
+    batch_init( &(sink.batches[BATCH_CBOR]), BATCH_CBOR, BATCH_MAX_FRAMES, BATCH_MAX_AGE_S, true );
+    decoder_input( &td, buf, len );
+    free( buf );
+    for( uint8_t format = BATCH_JSON; format <= BATCH_CBOR; format++ )
+    {
+        if( !batch_is_empty( &(sink.batches[format]) ) )
+        {
+            batch_publish( &sink, format, BATCH_FLUSH_AGE );
+        }
+    }
+
+    const batch_stats_t *js = &(sink.batches[BATCH_JSON].stats);
+    const batch_stats_t *cs = &(sink.batches[BATCH_CBOR].stats);
+    uint32_t frames = sink.fs.frames;
+    if( frames == 0 || sink.errors > 0 || js->frames != frames || cs->frames != frames || sink.relues != frames )
+    {
+        fprintf( stderr, "%s : %u trames, %u erreurs dans les lots\n", path, frames, sink.errors );
+        return 1;
+    }
+    printf( "%-10s lots de %d : JSON %u -> %3u messages %6zu -> %6zu bytes   CBOR %u -> %3u messages %6zu -> %6zu bytes\n",
+            mode_name, BATCH_MAX_FRAMES, frames, js->messages, sink.bytes_single[BATCH_JSON], sink.bytes_batch[BATCH_JSON],
+            frames, cs->messages, sink.bytes_single[BATCH_CBOR], sink.bytes_batch[BATCH_CBOR] );
+    return 0;
+}
+
+
+// ******************* assemblage d'une trame ******************
+static void bench_assemblage( void )
+{
+    static tic_frame_t frame;
+    static const size_t NB_LABELS[] = { 4, 8, 16, 32, TIC_LABEL_COUNT };
+    volatile uint32_t total = 0;
+
+    printf( "\nassemblage : dataset_new() + dataset_insert() puis parcours de la trame\n" );
+    for( size_t n = 0; n < sizeof(NB_LABELS)/sizeof(NB_LABELS[0]); n++ )
+    {
+        size_t nb = NB_LABELS[n];
+        uint64_t passes = 0;
+        uint64_t start = now_ns();
+        uint64_t elapsed;
+        do
+        {
+            frame_clear( &frame );
+            // ordre inverse des identifiants : le pire cas d'une insertion triée
+            for( size_t i = nb; i > 0; i-- )
+            {
+                const tic_char_t *name = label_name( i - 1 );
+                dataset_t *ds = dataset_new( &frame, i - 1, name, strlen( name ), NULL, 0, "000123", 6 );
+                if( ds )
+                {
+                    dataset_insert( &frame, ds );
+                }
+            }
+            for( const dataset_t *ds = dataset_first( &frame ); ds; ds = dataset_next( &frame, ds ) )
+            {
+                total += ds->label;
+            }
+            passes++;
+            elapsed = now_ns() - start;
+        } while( elapsed < MIN_DURATION_NS / 5 );
+
+        printf( "%3zu etiquettes : %8.1f ns/trame  %6.1f ns/etiquette\n",
+                nb, (double)elapsed / passes, (double)elapsed / passes / nb );
+    }
+}
+
+
+int main( int argc, char **argv )
+{
+    int err = 0;
+    if( argc == 1 )
+    {
+        err |= bench_capture( "historique", TIC_CAPTURES_DIR "/historique.tic" );
+        err |= bench_capture( "standard", TIC_CAPTURES_DIR "/standard.tic" );
+        printf( "\n" );
+        err |= bench_detect( "historique", TIC_CAPTURES_DIR "/historique.tic" );
+        err |= bench_detect( "standard", TIC_CAPTURES_DIR "/standard.tic" );
+        printf( "\n" );
+        err |= bench_salvage( "historique", TIC_CAPTURES_DIR "/historique.tic" );
+        err |= bench_salvage( "standard", TIC_CAPTURES_DIR "/standard.tic" );
+        err |= bench_stx( "historique", TIC_CAPTURES_DIR "/historique.tic" );
+        err |= bench_stx( "standard", TIC_CAPTURES_DIR "/standard.tic" );
+        printf( "\n" );
+        err |= bench_json( "historique", TIC_CAPTURES_DIR "/historique.tic" );
+        err |= bench_json( "standard", TIC_CAPTURES_DIR "/standard.tic" );
+        printf( "\n" );
+        err |= bench_cbor( "historique", TIC_CAPTURES_DIR "/historique.tic" );
+        err |= bench_cbor( "standard", TIC_CAPTURES_DIR "/standard.tic" );
+        err |= bench_puissance();
+        err |= bench_delta_perte();
+        err |= bench_delta( "historique", TIC_CAPTURES_DIR "/historique.tic" );
+        err |= bench_delta( "standard", TIC_CAPTURES_DIR "/standard.tic" );
+        err |= bench_batch( "historique", TIC_CAPTURES_DIR "/historique.tic" );
+        err |= bench_batch( "standard", TIC_CAPTURES_DIR "/standard.tic" );
+    }
+    else if( argc % 2 == 1 )
+    {
+        for( int i = 1; i < argc; i += 2 )
+        {
+            err |= bench_capture( argv[i], argv[i+1] );
+        }
+        printf( "\n" );
+        for( int i = 1; i < argc; i += 2 )
+        {
+            err |= bench_detect( argv[i], argv[i+1] );
+        }
+        printf( "\n" );
+        for( int i = 1; i < argc; i += 2 )
+        {
+            err |= bench_salvage( argv[i], argv[i+1] );
+        }
+        for( int i = 1; i < argc; i += 2 )
+        {
+            err |= bench_stx( argv[i], argv[i+1] );
+        }
+        printf( "\n" );
+        for( int i = 1; i < argc; i += 2 )
+        {
+            err |= bench_json( argv[i], argv[i+1] );
+        }
+        printf( "\n" );
+        for( int i = 1; i < argc; i += 2 )
+        {
+            err |= bench_cbor( argv[i], argv[i+1] );
+        }
+        err |= bench_puissance();
+        err |= bench_delta_perte();
+        for( int i = 1; i < argc; i += 2 )
+        {
+            err |= bench_delta( argv[i], argv[i+1] );
+        }
+        for( int i = 1; i < argc; i += 2 )
+        {
+            err |= bench_batch( argv[i], argv[i+1] );
+        }
+    }
+    else
+    {
+        fprintf( stderr, "usage : %s [standard|historique capture.tic] ...\n", argv[0] );
+        return 2;
+    }
+
+    bench_assemblage();
+    return err;
+}
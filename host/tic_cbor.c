@@ -0,0 +1,471 @@
+// Decodeur des payloads CBOR de cbor_writer.h, voir tic_cbor.h
+
+#include <string.h>
+#include <inttypes.h>
+
+#include "labels.h"
+#include "cbor_writer.h"
+#include "tic_cbor.h"
+
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+} reader_t;
+
+
+static int fail( const reader_t *r, const char *msg )
+{
+    fprintf( stderr, "CBOR invalide à l'offset %zu : %s\n", r->pos, msg );
+    return -1;
+}
+
+
+static int read_head( reader_t *r, uint8_t *major, uint64_t *arg )
+{
+    if( r->pos >= r->len )
+    {
+        return fail( r, "fin du payload" );
+    }
+    uint8_t ib = r->buf[r->pos++];
+    *major = ib >> 5;
+    uint8_t info = ib & 0x1F;
+    if( info < 24 )
+    {
+        *arg = info;
+        return 0;
+    }
+    if( info > 27 )
+    {
+        return fail( r, "longueur indéfinie non supportée" );
+    }
+    size_t n = (size_t)1 << ( info - 24 );
+    if( n > r->len - r->pos )
+    {
+        return fail( r, "argument tronqué" );
+    }
+    *arg = 0;
+    for( size_t i = 0; i < n; i++ )
+    {
+        *arg = ( *arg << 8 ) | r->buf[r->pos++];
+    }
+    return 0;
+}
+
+
+static int read_int( reader_t *r, int64_t *val )
+{
+    uint8_t major;
+    uint64_t arg;
+    if( read_head( r, &major, &arg ) != 0 )
+    {
+        return -1;
+    }
+    if( major == CBOR_UINT )
+    {
+        *val = (int64_t)arg;
+        return 0;
+    }
+    if( major == CBOR_NEGINT )
+    {
+        *val = -1 - (int64_t)arg;
+        return 0;
+    }
+    return fail( r, "entier attendu" );
+}
+
+
+// texte de longueur arg, copié et terminé par \0
+static int read_text_body( reader_t *r, uint64_t arg, char *out, size_t size )
+{
+    if( arg > r->len - r->pos || arg >= size )
+    {
+        return fail( r, "texte trop long" );
+    }
+    memcpy( out, &(r->buf[r->pos]), arg );
+    out[arg] = '\0';
+    r->pos += arg;
+    return 0;
+}
+
+
+// entier ou texte
+static int read_scalar( reader_t *r, bool *is_int, int64_t *val, char *text, size_t size )
+{
+    uint8_t major;
+    uint64_t arg;
+    if( read_head( r, &major, &arg ) != 0 )
+    {
+        return -1;
+    }
+    switch( major )
+    {
+        case CBOR_UINT:
+            *is_int = true;
+            *val = (int64_t)arg;
+            return 0;
+        case CBOR_NEGINT:
+            *is_int = true;
+            *val = -1 - (int64_t)arg;
+            return 0;
+        case CBOR_TEXT:
+            *is_int = false;
+            return read_text_body( r, arg, text, size );
+        default:
+            return fail( r, "entier ou texte attendu" );
+    }
+}
+
+
+static int read_entry( reader_t *r, tic_cbor_entry_t *e )
+{
+    memset( e, 0, sizeof(*e) );
+
+    bool key_is_int;
+    int64_t key;
+    if( read_scalar( r, &key_is_int, &key, e->etiquette, sizeof(e->etiquette) ) != 0 )
+    {
+        return -1;
+    }
+    e->label = -1;
+    if( key_is_int )
+    {
+        tic_label_id_t id = label_from_wire( key < 0 || key > UINT32_MAX ? TIC_LABEL_WIRE_INCONNU : (uint32_t)key );
+        if( id == TIC_LABEL_INCONNU )
+        {
+            return fail( r, "identifiant d'etiquette inconnu" );
+        }
+        e->label = (int)id;
+        snprintf( e->etiquette, sizeof(e->etiquette), "%s", label_name( id ) );
+    }
+
+    // [horodate, valeur] ou valeur
+    size_t mark = r->pos;
+    uint8_t major;
+    uint64_t arg;
+    if( read_head( r, &major, &arg ) != 0 )
+    {
+        return -1;
+    }
+    if( major == CBOR_ARRAY )
+    {
+        if( arg != 2 )
+        {
+            return fail( r, "[horodate, valeur] attendu" );
+        }
+        e->has_horodate = true;
+        bool ts_is_int;
+        if( read_scalar( r, &ts_is_int, &(e->horodate), e->horodate_text, sizeof(e->horodate_text) ) != 0 )
+        {
+            return -1;
+        }
+        e->horodate_is_text = !ts_is_int;
+    }
+    else
+    {
+        r->pos = mark;
+    }
+    return read_scalar( r, &(e->is_int), &(e->val), e->text, sizeof(e->text) );
+}
+
+
+// document d'une trame
+static int read_frame( reader_t *r, tic_cbor_frame_t *out )
+{
+    memset( out, 0, sizeof(*out) );
+
+    uint8_t major;
+    uint64_t nb_keys;
+    if( read_head( r, &major, &nb_keys ) != 0 )
+    {
+        return -1;
+    }
+    if( major != CBOR_MAP )
+    {
+        return fail( r, "map attendue" );
+    }
+
+    for( uint64_t k = 0; k < nb_keys; k++ )
+    {
+        int64_t key;
+        if( read_int( r, &key ) != 0 )
+        {
+            return -1;
+        }
+        uint64_t arg;
+        switch( key )
+        {
+            case TIC_CBOR_ESP_TIME:
+                if( read_head( r, &major, &arg ) != 0 )
+                {
+                    return -1;
+                }
+                if( major != CBOR_TAG || arg != CBOR_TAG_EPOCH )
+                {
+                    return fail( r, "tag 1 attendu" );
+                }
+                if( read_int( r, &(out->esp_time) ) != 0 )
+                {
+                    return -1;
+                }
+                break;
+
+            case TIC_CBOR_FREE_MEM:
+                if( read_head( r, &major, &(out->esp_free_mem) ) != 0 )
+                {
+                    return -1;
+                }
+                if( major != CBOR_UINT )
+                {
+                    return fail( r, "entier positif attendu" );
+                }
+                break;
+
+            case TIC_CBOR_DROPPED:
+                if( read_head( r, &major, &arg ) != 0 )
+                {
+                    return -1;
+                }
+                if( major != CBOR_ARRAY || arg > TIC_FRAME_MAX_REJETS )
+                {
+                    return fail( r, "tableau des etiquettes écartées attendu" );
+                }
+                out->incomplete = true;
+                out->nb_dropped = arg;
+                for( size_t i = 0; i < out->nb_dropped; i++ )
+                {
+                    bool is_int;
+                    int64_t label;
+                    char text[4];
+                    if( read_scalar( r, &is_int, &label, text, sizeof(text) ) != 0 )
+                    {
+                        return -1;
+                    }
+                    tic_label_id_t id = is_int && label >= 0 && label <= UINT32_MAX ? label_from_wire( (uint32_t)label ) : TIC_LABEL_INCONNU;
+                    out->dropped[i] = id == TIC_LABEL_INCONNU ? -1 : (int)id;
+                }
+                break;
+
+            case TIC_CBOR_DELTA:
+                if( read_head( r, &major, &arg ) != 0 )
+                {
+                    return -1;
+                }
+                if( major != CBOR_SIMPLE || arg != CBOR_TRUE )
+                {
+                    return fail( r, "true attendu" );
+                }
+                out->delta = true;
+                break;
+
+            case TIC_CBOR_TIC:
+                if( read_head( r, &major, &arg ) != 0 )
+                {
+                    return -1;
+                }
+                if( major != CBOR_MAP || arg > TIC_CBOR_MAX_ENTRIES )
+                {
+                    return fail( r, "map des etiquettes attendue" );
+                }
+                out->nb_entries = arg;
+                for( size_t i = 0; i < out->nb_entries; i++ )
+                {
+                    if( read_entry( r, &(out->entries[i]) ) != 0 )
+                    {
+                        return -1;
+                    }
+                }
+                break;
+
+            default:
+                return fail( r, "clé inconnue" );
+        }
+    }
+    return 0;
+}
+
+
+static int check_end( const reader_t *r )
+{
+    if( r->pos != r->len )
+    {
+        return fail( r, "bytes en trop après le document" );
+    }
+    return 0;
+}
+
+
+int tic_cbor_decode( const uint8_t *buf, size_t len, tic_cbor_frame_t *out )
+{
+    reader_t r = { buf, len, 0 };
+    if( read_frame( &r, out ) != 0 )
+    {
+        return -1;
+    }
+    return check_end( &r );
+}
+
+
+bool tic_cbor_is_batch( const uint8_t *buf, size_t len )
+{
+    return len >= 2 && ( buf[0] >> 5 ) == CBOR_MAP && buf[1] == TIC_CBOR_FRAMES;
+}
+
+
+int tic_cbor_decode_batch( const uint8_t *buf, size_t len, tic_cbor_batch_t *out, tic_cbor_frame_cb_t frame_cb, void *ctx )
+{
+    reader_t r = { buf, len, 0 };
+    memset( out, 0, sizeof(*out) );
+    static tic_cbor_frame_t cf;
+
+    uint8_t major;
+    uint64_t nb_keys;
+    if( read_head( &r, &major, &nb_keys ) != 0 )
+    {
+        return -1;
+    }
+    if( major != CBOR_MAP )
+    {
+        return fail( &r, "map attendue" );
+    }
+
+    for( uint64_t k = 0; k < nb_keys; k++ )
+    {
+        int64_t key;
+        uint64_t arg;
+        if( read_int( &r, &key ) != 0 || read_head( &r, &major, &arg ) != 0 )
+        {
+            return -1;
+        }
+        switch( key )
+        {
+            case TIC_CBOR_FRAMES:
+                if( major != CBOR_ARRAY )
+                {
+                    return fail( &r, "tableau des trames attendu" );
+                }
+                out->nb_frames = arg;
+                for( size_t i = 0; i < out->nb_frames; i++ )
+                {
+                    if( read_frame( &r, &cf ) != 0 )
+                    {
+                        return -1;
+                    }
+                    frame_cb( &cf, ctx );
+                }
+                break;
+
+            case TIC_CBOR_AGG:
+                if( major != CBOR_MAP || arg > TIC_LABEL_COUNT )
+                {
+                    return fail( &r, "map des agrégats attendue" );
+                }
+                out->nb_agg = arg;
+                for( size_t i = 0; i < out->nb_agg; i++ )
+                {
+                    tic_cbor_agg_t *a = &(out->agg[i]);
+                    int64_t label;
+                    if( read_int( &r, &label ) != 0 || read_head( &r, &major, &arg ) != 0 )
+                    {
+                        return -1;
+                    }
+                    tic_label_id_t id = label >= 0 && label <= UINT32_MAX ? label_from_wire( (uint32_t)label ) : TIC_LABEL_INCONNU;
+                    if( id == TIC_LABEL_INCONNU || major != CBOR_ARRAY || arg != 3 )
+                    {
+                        return fail( &r, "identifiant: [min, max, dernière] attendu" );
+                    }
+                    a->label = (int)id;
+                    if( read_int( &r, &(a->min) ) != 0 || read_int( &r, &(a->max) ) != 0 || read_int( &r, &(a->last) ) != 0 )
+                    {
+                        return -1;
+                    }
+                }
+                break;
+
+            default:
+                return fail( &r, "clé inconnue" );
+        }
+    }
+    return check_end( &r );
+}
+
+
+static void print_string( const char *txt, FILE *f )
+{
+    fputc( '"', f );
+    for( const char *p = txt; *p; p++ )
+    {
+        if( *p == '"' || *p == '\\' )
+        {
+            fputc( '\\', f );
+        }
+        fputc( *p, f );
+    }
+    fputc( '"', f );
+}
+
+
+void tic_cbor_print_agg( const tic_cbor_batch_t *batch, FILE *f )
+{
+    fprintf( f, "\"agg\":{" );
+    for( size_t i = 0; i < batch->nb_agg; i++ )
+    {
+        const tic_cbor_agg_t *a = &(batch->agg[i]);
+        fprintf( f, "%s", ( i > 0 ) ? "," : "" );
+        print_string( label_name( a->label ), f );
+        fprintf( f, ":[%" PRId64 ",%" PRId64 ",%" PRId64 "]", a->min, a->max, a->last );
+    }
+    fprintf( f, "}" );
+}
+
+
+void tic_cbor_print( const tic_cbor_frame_t *cf, FILE *f )
+{
+    fprintf( f, "{\n\"esp_time\":%" PRId64 ",\n\"esp_free_mem\":%" PRIu64 ",\n", cf->esp_time, cf->esp_free_mem );
+    if( cf->delta )
+    {
+        fprintf( f, "\"delta\":true,\n" );
+    }
+    if( cf->incomplete )
+    {
+        fprintf( f, "\"incomplete\":true,\n\"dropped\":[" );
+        for( size_t i = 0; i < cf->nb_dropped; i++ )
+        {
+            fprintf( f, "%s", ( i > 0 ) ? "," : "" );
+            print_string( ( cf->dropped[i] < 0 ) ? "?" : label_name( cf->dropped[i] ), f );
+        }
+        fprintf( f, "],\n" );
+    }
+    fprintf( f, "\"tic\" : {\n" );
+    for( size_t i = 0; i < cf->nb_entries; i++ )
+    {
+        const tic_cbor_entry_t *e = &(cf->entries[i]);
+        fprintf( f, "%s  ", ( i > 0 ) ? ",\n" : "" );
+        print_string( e->etiquette, f );
+        fprintf( f, ":{" );
+        if( e->has_horodate )
+        {
+            fprintf( f, "\"horodate\":" );
+            if( e->horodate_is_text )
+            {
+                print_string( e->horodate_text, f );
+            }
+            else
+            {
+                fprintf( f, "%" PRId64, e->horodate );
+            }
+            fprintf( f, ", " );
+        }
+        fprintf( f, "\"val\":" );
+        if( e->is_int )
+        {
+            fprintf( f, "%" PRId64, e->val );
+        }
+        else
+        {
+            print_string( e->text, f );
+        }
+        fprintf( f, "}" );
+    }
+    fprintf( f, "%s} }\n", ( cf->nb_entries > 0 ) ? "\n" : "" );
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+// Decodeur des payloads CBOR de cbor_writer.h, pour les tests sur PC et tic_cbor_dump
+// Ne lit que le sous-ensemble produit par cbor_write_frame() et batch.h : longueurs définies,
+// entiers, textes, tableaux, maps, tag 1 et true
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "tic_types.h"
+
+#define TIC_CBOR_MAX_ENTRIES   TIC_FRAME_MAX_DATASETS
+#define TIC_CBOR_MAX_TEXT      TIC_SIZE_VALUE
+
+// une etiquette du payload
+typedef struct {
+    int label;                              // identifiant de tic_labels.h, -1 si etiquette en texte
+    char etiquette[TIC_SIZE_ETIQUETTE];     // texte de l'etiquette ( label_name() si identifiant )
+    bool has_horodate;
+    bool horodate_is_text;                  // horodate non convertie par l'ESP
+    int64_t horodate;                       // temps unix
+    char horodate_text[TIC_CBOR_MAX_TEXT];
+    bool is_int;
+    int64_t val;
+    char text[TIC_CBOR_MAX_TEXT];
+} tic_cbor_entry_t;
+
+typedef struct {
+    int64_t esp_time;
+    uint64_t esp_free_mem;
+    bool delta;
+    bool incomplete;
+    size_t nb_dropped;
+    int dropped[TIC_FRAME_MAX_REJETS];      // -1 si illisible
+    size_t nb_entries;
+    tic_cbor_entry_t entries[TIC_CBOR_MAX_ENTRIES];
+} tic_cbor_frame_t;
+
+// agrégat d'une etiquette dans un lot de trames
+typedef struct {
+    int label;
+    int64_t min;
+    int64_t max;
+    int64_t last;
+} tic_cbor_agg_t;
+
+typedef struct {
+    size_t nb_frames;
+    size_t nb_agg;
+    tic_cbor_agg_t agg[TIC_LABEL_COUNT];
+} tic_cbor_batch_t;
+
+typedef void (*tic_cbor_frame_cb_t)( const tic_cbor_frame_t *cf, void *ctx );
+
+// 0 si le payload est valide, -1 sinon ( le message d'erreur est écrit sur stderr )
+int tic_cbor_decode( const uint8_t *buf, size_t len, tic_cbor_frame_t *out );
+
+// lot de trames de batch.h ( home/elec/<compteur>/cbor/batch )
+bool tic_cbor_is_batch( const uint8_t *buf, size_t len );
+
+// frame_cb est appelé pour chaque trame du lot, 0 si le payload est valide
+int tic_cbor_decode_batch( const uint8_t *buf, size_t len, tic_cbor_batch_t *out, tic_cbor_frame_cb_t frame_cb, void *ctx );
+
+// "agg":{...} d'un lot décodé
+void tic_cbor_print_agg( const tic_cbor_batch_t *batch, FILE *f );
+
+// affiche la trame décodée en JSON, avec le nom des etiquettes
+void tic_cbor_print( const tic_cbor_frame_t *cf, FILE *f );
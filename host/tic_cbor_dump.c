@@ -0,0 +1,69 @@
+// Affiche en JSON un payload CBOR publié sur home/elec/<compteur>/cbor
+// ou un lot de trames publié sur home/elec/<compteur>/cbor/batch
+//
+// usage : tic_cbor_dump payload.cbor
+//         mosquitto_sub -t 'home/elec/+/cbor' -C 1 -N | tic_cbor_dump -
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tic_cbor.h"
+
+static void print_frame( const tic_cbor_frame_t *cf, void *ctx )
+{
+    size_t *nb = ctx;
+    printf( "%s", ( (*nb)++ > 0 ) ? "," : "" );
+    tic_cbor_print( cf, stdout );
+}
+
+
+int main( int argc, char **argv )
+{
+    if( argc != 2 )
+    {
+        fprintf( stderr, "usage : %s payload.cbor|-\n", argv[0] );
+        return 2;
+    }
+
+    FILE *f = ( strcmp( argv[1], "-" ) == 0 ) ? stdin : fopen( argv[1], "rb" );
+    if( f == NULL )
+    {
+        perror( argv[1] );
+        return 1;
+    }
+    static uint8_t buf[4096];
+    size_t len = fread( buf, 1, sizeof(buf), f );
+    if( f != stdin )
+    {
+        fclose( f );
+    }
+
+    if( tic_cbor_is_batch( buf, len ) )
+    {
+        // les trames sont affichées au fil du décodage
+        static tic_cbor_batch_t batch;
+        size_t nb = 0;
+        printf( "{\"frames\":[" );
+        if( tic_cbor_decode_batch( buf, len, &batch, print_frame, &nb ) != 0 )
+        {
+            return 1;
+        }
+        printf( "]" );
+        if( batch.nb_agg > 0 )
+        {
+            printf( ",\n" );
+            tic_cbor_print_agg( &batch, stdout );
+        }
+        printf( "}\n" );
+        return 0;
+    }
+
+    static tic_cbor_frame_t cf;
+    if( tic_cbor_decode( buf, len, &cf ) != 0 )
+    {
+        return 1;
+    }
+    tic_cbor_print( &cf, stdout );
+    return 0;
+}
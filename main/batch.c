@@ -0,0 +1,273 @@
+#include <string.h>
+
+#include "tic_log.h"
+
+#include "tic_types.h"
+#include "dataset.h"
+#include "labels.h"
+#include "json_writer.h"
+#include "cbor_writer.h"
+#include "batch.h"
+
+static const char *TAG = "batch.c";
+
+// enveloppe JSON du lot
+#define JSON_DEBUT      "{\"frames\":["
+#define JSON_FIN_FRAMES "]"
+#define JSON_AGG        ",\"agg\":{"
+#define JSON_FIN_AGG    "}"
+#define JSON_FIN        "}\n"
+#define LIT_LEN( litteral )   ( sizeof(litteral) - 1 )
+
+
+void batch_init( batch_t *b, uint8_t format, uint32_t max_frames, uint32_t max_age_s, bool aggregates )
+{
+    memset( b, 0, sizeof(*b) );
+    b->format = format;
+    b->aggregates = aggregates;
+    b->max_frames = max_frames;
+    b->max_age_us = (int64_t)max_age_s * 1000000;
+}
+
+
+bool batch_is_empty( const batch_t *b )
+{
+    return b->nb_frames == 0;
+}
+
+
+static size_t json_int_len( int32_t val )
+{
+    size_t len = ( val < 0 ) ? 2 : 1;
+    uint32_t u = ( val < 0 ) ? -(uint32_t)val : (uint32_t)val;
+    while( u >= 10 )
+    {
+        u /= 10;
+        len++;
+    }
+    return len;
+}
+
+
+// agrégat de l'etiquette après ajout de la trame ( frame NULL : agrégat actuel )
+// false si l'etiquette n'a aucune valeur entière dans le lot
+static bool agg_value( const batch_t *b, const tic_frame_t *frame, tic_label_id_t label, batch_agg_t *out )
+{
+    bool connu = b->agg_present[label / 32] & ( 1UL << (label % 32) );
+    if( connu )
+    {
+        *out = b->agg[label];
+    }
+    const dataset_t *ds = frame ? dataset_find( frame, label ) : NULL;
+    if( ds == NULL || ds->type != TIC_TYPE_ENTIER )
+    {
+        return connu;
+    }
+    int32_t val = ds->val.entier;
+    if( !connu || val < out->min )
+    {
+        out->min = val;
+    }
+    if( !connu || val > out->max )
+    {
+        out->max = val;
+    }
+    out->last = val;
+    return true;
+}
+
+
+// taille encodée des agrégats après ajout de la trame
+static size_t agg_size( const batch_t *b, const tic_frame_t *frame )
+{
+    size_t size = 0;
+    size_t nb = 0;
+    for( tic_label_id_t label = 0; label < TIC_LABEL_COUNT; label++ )
+    {
+        batch_agg_t agg;
+        if( !agg_value( b, frame, label, &agg ) )
+        {
+            continue;
+        }
+        nb++;
+        if( b->format == BATCH_CBOR )
+        {
+            size += cbor_head_size( label_wire( label ) ) + cbor_head_size( 3 )
+                  + cbor_int_size( agg.min ) + cbor_int_size( agg.max ) + cbor_int_size( agg.last );
+        }
+        else
+        {
+            // "PAPP":[min,max,last] et la virgule qui précède
+            size += ( nb > 1 ) + strlen( label_name( label ) ) + 2 + LIT_LEN( ":[,,]" )
+                  + json_int_len( agg.min ) + json_int_len( agg.max ) + json_int_len( agg.last );
+        }
+    }
+    if( b->format == BATCH_CBOR )
+    {
+        return cbor_head_size( TIC_CBOR_AGG ) + cbor_head_size( nb ) + size;
+    }
+    return LIT_LEN( JSON_AGG ) + size + LIT_LEN( JSON_FIN_AGG );
+}
+
+
+// taille du message complet de nb_frames trames, docs_len bytes de documents
+static size_t message_size( const batch_t *b, uint32_t nb_frames, size_t docs_len, const tic_frame_t *frame )
+{
+    size_t size;
+    if( b->format == BATCH_CBOR )
+    {
+        size = cbor_head_size( 2 ) + cbor_head_size( TIC_CBOR_FRAMES ) + cbor_head_size( nb_frames ) + docs_len;
+    }
+    else
+    {
+        size = LIT_LEN( JSON_DEBUT ) + docs_len + LIT_LEN( JSON_FIN_FRAMES ) + LIT_LEN( JSON_FIN ) + 1;     // \0 final
+    }
+    return size + ( b->aggregates ? agg_size( b, frame ) : 0 );
+}
+
+
+tic_error_t batch_add( batch_t *b, const void *doc, size_t len, const tic_frame_t *frame, int64_t now_us )
+{
+    size_t sep = ( b->format == BATCH_JSON && b->nb_frames > 0 ) ? 1 : 0;
+    if( message_size( b, b->nb_frames + 1, b->len + sep + len, frame ) > MQTT_PAYLOAD_BUFFER_SIZE )
+    {
+        return TIC_ERR_OVERFLOW;
+    }
+
+    if( sep )
+    {
+        b->docs[b->len++] = ',';
+    }
+    memcpy( &(b->docs[b->len]), doc, len );
+    b->len += len;
+
+    if( b->aggregates )
+    {
+        for( tic_label_id_t label = 0; label < TIC_LABEL_COUNT; label++ )
+        {
+            if( agg_value( b, frame, label, &(b->agg[label]) ) )
+            {
+                b->agg_present[label / 32] |= 1UL << (label % 32);
+            }
+        }
+    }
+
+    if( b->nb_frames == 0 )
+    {
+        b->first_us = now_us;
+    }
+    b->nb_frames++;
+    return TIC_OK;
+}
+
+
+batch_flush_t batch_due( const batch_t *b, int64_t now_us, bool urgent )
+{
+    if( batch_is_empty( b ) )
+    {
+        return BATCH_FLUSH_NONE;
+    }
+    if( urgent )
+    {
+        return BATCH_FLUSH_URGENT;
+    }
+    if( b->nb_frames >= b->max_frames )
+    {
+        return BATCH_FLUSH_COUNT;
+    }
+    if( now_us - b->first_us >= b->max_age_us )
+    {
+        return BATCH_FLUSH_AGE;
+    }
+    return BATCH_FLUSH_NONE;
+}
+
+
+static tic_error_t finish_json( const batch_t *b, char *buf, size_t size, size_t *len )
+{
+    json_writer_t jw;
+    json_init( &jw, buf, size );
+    JSON_RAW( &jw, JSON_DEBUT );
+    json_raw( &jw, (const char *)b->docs, b->len );
+    JSON_RAW( &jw, JSON_FIN_FRAMES );
+    if( b->aggregates )
+    {
+        JSON_RAW( &jw, JSON_AGG );
+        bool premier = true;
+        for( tic_label_id_t label = 0; label < TIC_LABEL_COUNT; label++ )
+        {
+            batch_agg_t agg;
+            if( !agg_value( b, NULL, label, &agg ) )
+            {
+                continue;
+            }
+            if( !premier )
+            {
+                JSON_RAW( &jw, "," );
+            }
+            premier = false;
+            const char *name = label_name( label );
+            json_string( &jw, name, strlen( name ) );
+            JSON_RAW( &jw, ":[" );
+            json_int( &jw, agg.min );
+            JSON_RAW( &jw, "," );
+            json_int( &jw, agg.max );
+            JSON_RAW( &jw, "," );
+            json_int( &jw, agg.last );
+            JSON_RAW( &jw, "]" );
+        }
+        JSON_RAW( &jw, JSON_FIN_AGG );
+    }
+    JSON_RAW( &jw, JSON_FIN );
+    return json_finish( &jw, len );
+}
+
+
+static tic_error_t finish_cbor( const batch_t *b, char *buf, size_t size, size_t *len )
+{
+    cbor_writer_t cw;
+    cbor_init( &cw, (uint8_t *)buf, size );
+    cbor_head( &cw, CBOR_MAP, b->aggregates ? 2 : 1 );
+    cbor_head( &cw, CBOR_UINT, TIC_CBOR_FRAMES );
+    cbor_head( &cw, CBOR_ARRAY, b->nb_frames );
+    cbor_raw( &cw, b->docs, b->len );
+    if( b->aggregates )
+    {
+        size_t nb = 0;
+        for( tic_label_id_t label = 0; label < TIC_LABEL_COUNT; label++ )
+        {
+            nb += ( b->agg_present[label / 32] >> (label % 32) ) & 1;
+        }
+        cbor_head( &cw, CBOR_UINT, TIC_CBOR_AGG );
+        cbor_head( &cw, CBOR_MAP, nb );
+        for( tic_label_id_t label = 0; label < TIC_LABEL_COUNT; label++ )
+        {
+            batch_agg_t agg;
+            if( !agg_value( b, NULL, label, &agg ) )
+            {
+                continue;
+            }
+            cbor_head( &cw, CBOR_UINT, label_wire( label ) );
+            cbor_head( &cw, CBOR_ARRAY, 3 );
+            cbor_int( &cw, agg.min );
+            cbor_int( &cw, agg.max );
+            cbor_int( &cw, agg.last );
+        }
+    }
+    return cbor_finish( &cw, len );
+}
+
+
+tic_error_t batch_finish( batch_t *b, char *buf, size_t size, size_t *len, batch_flush_t cause )
+{
+    tic_error_t err = ( b->format == BATCH_CBOR ) ? finish_cbor( b, buf, size, len ) : finish_json( b, buf, size, len );
+    ESP_LOGD( TAG, "lot de %u trames, %u bytes, raison %d", (unsigned)b->nb_frames, (unsigned)*len, cause );
+
+    b->stats.messages++;
+    b->stats.frames += b->nb_frames;
+    b->stats.flushes[cause]++;
+    b->len = 0;
+    b->nb_frames = 0;
+    memset( b->agg_present, 0, sizeof(b->agg_present) );
+    return err;
+}
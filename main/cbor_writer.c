@@ -0,0 +1,261 @@
+#include <string.h>
+
+#include "tic_log.h"
+
+#include "tic_types.h"
+#include "dataset.h"
+#include "labels.h"
+#include "cbor_writer.h"
+
+static const char *TAG = "cbor_writer.c";
+
+
+void cbor_init( cbor_writer_t *cw, uint8_t *buf, size_t size )
+{
+    cw->buf = buf;
+    cw->size = size;
+    cw->pos = 0;
+    cw->overflow = false;
+}
+
+
+static uint8_t * reserve( cbor_writer_t *cw, size_t len )
+{
+    if( cw->overflow || len > cw->size - cw->pos )
+    {
+        cw->overflow = true;
+        return NULL;
+    }
+    uint8_t *p = &(cw->buf[cw->pos]);
+    cw->pos += len;
+    return p;
+}
+
+
+void cbor_head( cbor_writer_t *cw, uint8_t major, uint64_t arg )
+{
+    // argument dans l'octet initial jusqu'à 23, sinon sur 1, 2, 4 ou 8 bytes big endian
+    uint8_t extra;
+    uint8_t info;
+    if( arg < 24 )
+    {
+        extra = 0;
+        info = arg;
+    }
+    else if( arg <= 0xFF )
+    {
+        extra = 1;
+        info = 24;
+    }
+    else if( arg <= 0xFFFF )
+    {
+        extra = 2;
+        info = 25;
+    }
+    else if( arg <= 0xFFFFFFFF )
+    {
+        extra = 4;
+        info = 26;
+    }
+    else
+    {
+        extra = 8;
+        info = 27;
+    }
+
+    uint8_t *p = reserve( cw, 1 + extra );
+    if( p == NULL )
+    {
+        return;
+    }
+    p[0] = ( major << 5 ) | info;
+    for( size_t i = extra; i > 0; i-- )
+    {
+        p[i] = arg & 0xFF;
+        arg >>= 8;
+    }
+}
+
+
+size_t cbor_head_size( uint64_t arg )
+{
+    return ( arg < 24 ) ? 1 : ( arg <= 0xFF ) ? 2 : ( arg <= 0xFFFF ) ? 3 : ( arg <= 0xFFFFFFFF ) ? 5 : 9;
+}
+
+
+size_t cbor_int_size( int64_t val )
+{
+    return cbor_head_size( ( val < 0 ) ? ~(uint64_t)val : (uint64_t)val );
+}
+
+
+void cbor_int( cbor_writer_t *cw, int64_t val )
+{
+    if( val < 0 )
+    {
+        // -1 - n, sans débordement pour INT64_MIN
+        cbor_head( cw, CBOR_NEGINT, ~(uint64_t)val );
+        return;
+    }
+    cbor_head( cw, CBOR_UINT, (uint64_t)val );
+}
+
+
+void cbor_text( cbor_writer_t *cw, const char *txt, size_t len )
+{
+    cbor_head( cw, CBOR_TEXT, len );
+    uint8_t *p = reserve( cw, len );
+    if( p )
+    {
+        memcpy( p, txt, len );
+    }
+}
+
+
+void cbor_raw( cbor_writer_t *cw, const uint8_t *data, size_t len )
+{
+    uint8_t *p = reserve( cw, len );
+    if( p )
+    {
+        memcpy( p, data, len );
+    }
+}
+
+
+tic_error_t cbor_finish( cbor_writer_t *cw, size_t *len )
+{
+    if( len )
+    {
+        *len = cw->pos;
+    }
+    if( cw->overflow )
+    {
+        ESP_LOGE( TAG, "CBOR buffer overflow (%zu bytes)", cw->size );
+        return TIC_ERR_OVERFLOW;
+    }
+    return TIC_OK;
+}
+
+
+// etiquette déjà écrite dans la map : doublon de la zone des inconnus ( même etiquette connue,
+// ou même texte d'etiquette inconnue ), seule la 1re occurrence est publiée ( RFC 8949 §5.6 )
+static bool cle_en_double( const tic_frame_t *frame, const dataset_t *ds )
+{
+    if( ds - frame->datasets < TIC_LABEL_COUNT )
+    {
+        return false;       // emplacement de l'etiquette : toujours la 1re occurrence
+    }
+    for( const dataset_t *prec = dataset_first( frame ); prec != NULL && prec != ds; prec = dataset_next( frame, prec ) )
+    {
+        if( (prec->flags & TIC_DS_PUBLISHED) == 0 || prec->label != ds->label )
+        {
+            continue;
+        }
+        if(    ds->label != TIC_LABEL_INCONNU
+            || (    prec->etiquette.len == ds->etiquette.len
+                 && memcmp( dataset_etiquette( frame, prec ), dataset_etiquette( frame, ds ), ds->etiquette.len ) == 0 ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+static bool publie( const tic_frame_t *frame, const dataset_t *ds )
+{
+    return ( ds->flags & TIC_DS_PUBLISHED ) && !cle_en_double( frame, ds );
+}
+
+
+static void write_dataset( cbor_writer_t *cw, const tic_frame_t *frame, const dataset_t *ds )
+{
+    // clé : identifiant figé de l'etiquette, texte si inconnue
+    if( ds->label == TIC_LABEL_INCONNU )
+    {
+        cbor_text( cw, dataset_etiquette( frame, ds ), ds->etiquette.len );
+    }
+    else
+    {
+        cbor_head( cw, CBOR_UINT, label_wire( ds->label ) );
+    }
+
+    if( ds->flags & TIC_DS_HAS_TIMESTAMP )
+    {
+        cbor_head( cw, CBOR_ARRAY, 2 );
+        if( ds->ts != 0 )
+        {
+            cbor_head( cw, CBOR_UINT, ds->ts );
+        }
+        else
+        {
+            cbor_text( cw, dataset_horodate( frame, ds ), ds->horodate.len );
+        }
+    }
+
+    if( ds->type == TIC_TYPE_ENTIER )
+    {
+        cbor_int( cw, ds->val.entier );
+    }
+    else
+    {
+        cbor_text( cw, dataset_valeur( frame, ds ), ds->valeur.len );
+    }
+}
+
+
+void cbor_write_frame( cbor_writer_t *cw, const tic_frame_t *frame, int64_t esp_time, uint32_t esp_free_mem )
+{
+    // les longueurs des maps sont écrites avant leur contenu
+    size_t nb_publies = 0;
+    for( const dataset_t *ds = dataset_first( frame ); ds != NULL; ds = dataset_next( frame, ds ) )
+    {
+        if( publie( frame, ds ) )
+        {
+            nb_publies++;
+        }
+    }
+    size_t nb_rejets = ( frame->nb_rejets < TIC_FRAME_MAX_REJETS ) ? frame->nb_rejets : TIC_FRAME_MAX_REJETS;
+
+    cbor_head( cw, CBOR_MAP, 3 + ( nb_rejets > 0 ) + ( frame->delta != 0 ) );
+
+    cbor_head( cw, CBOR_UINT, TIC_CBOR_ESP_TIME );
+    cbor_head( cw, CBOR_TAG, CBOR_TAG_EPOCH );
+    cbor_int( cw, esp_time );
+
+    cbor_head( cw, CBOR_UINT, TIC_CBOR_FREE_MEM );
+    cbor_head( cw, CBOR_UINT, esp_free_mem );
+
+    if( nb_rejets > 0 )
+    {
+        cbor_head( cw, CBOR_UINT, TIC_CBOR_DROPPED );
+        cbor_head( cw, CBOR_ARRAY, nb_rejets );
+        for( size_t i = 0; i < nb_rejets; i++ )
+        {
+            if( frame->rejets[i] == TIC_LABEL_INCONNU )
+            {
+                cbor_text( cw, "?", 1 );
+            }
+            else
+            {
+                cbor_head( cw, CBOR_UINT, label_wire( frame->rejets[i] ) );
+            }
+        }
+    }
+
+    if( frame->delta )
+    {
+        cbor_head( cw, CBOR_UINT, TIC_CBOR_DELTA );
+        cbor_head( cw, CBOR_SIMPLE, CBOR_TRUE );
+    }
+
+    cbor_head( cw, CBOR_UINT, TIC_CBOR_TIC );
+    cbor_head( cw, CBOR_MAP, nb_publies );
+    for( const dataset_t *ds = dataset_first( frame ); ds != NULL; ds = dataset_next( frame, ds ) )
+    {
+        if( publie( frame, ds ) )
+        {
+            write_dataset( cw, frame, ds );
+        }
+    }
+}
@@ -1,101 +1,23 @@
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "esp_log.h"
+#include <assert.h>
+#include <stdbool.h>
+
+#include "tic_log.h"
 
 #include "tic_types.h"
+#include "labels.h"
 #include "dataset.h"
 
 static const char *TAG = "dataset.c";
 
-#define TEXTE (TIC_DS_PUBLISHED)
-#define NUMERIQUE (TIC_DS_PUBLISHED|TIC_DS_NUMERIQUE)
-#define TEXTE_TS (TEXTE|TIC_DS_HAS_TIMESTAMP)
-#define NUMERIQUE_TS (NUMERIQUE|TIC_DS_HAS_TIMESTAMP)
-#define IGNORE 0
-
-// donnees en mode historique
-static const char *LABEL_ADCO   = "ADCO";
-static const char *LABEL_BASE   = "BASE";
-static const char *LABEL_PAPP   = "PAPP";
-
-// donnees en mode standard 
-static const char *LABEL_ADSC   = "ADSC";
-static const char *LABEL_EAST   = "EAST";
-static const char *LABEL_SINSTS = "SINSTS";
-static const char *LABEL_DATE   = "DATE";   // en mode standard uniquement
-static const char *LABEL_VTIC   = "VTIC";   // en mode standard uniquement
-
-static const char *TIC_V2       = "02";
-
 // identifiant compteur si ADCO ou ADSC sont absents
 static const char *MISSING_ID = "_missing_id_"; 
 
 
-static const flags_definition_t TIC_DATA_STANDARD[] = {
-    {.label="ADSC",    .flags=TEXTE},              // numero de serie du compteur
-    {.label="EAST",    .flags=NUMERIQUE},          // energie active soutirée
-    {.label="IRMS1",   .flags=NUMERIQUE},          // intensite instantanée
-    {.label="URMS1",   .flags=NUMERIQUE},          // tension instantanée
-    {.label="SINSTS",  .flags=NUMERIQUE},          // Puissance apparente instantanée
-    {.label="STGE",    .flags=IGNORE},              // flags d'état   
-    {.label="DATE",    .flags=TEXTE_TS},           // heure et date courante (sans données)
-    {.label="CCASN",   .flags=NUMERIQUE_TS},       // courbe de charge de la periode N (pas 30 minutes)
-    {.label="CCASN-1", .flags=NUMERIQUE_TS},       // courbe de charge de la période N-1 (pas 30 minutes)
-    {.label="SMAXSN",  .flags=NUMERIQUE_TS},       // puissance apparente maxi du jour en cours
-    {.label="SMAXSN-1",.flags=NUMERIQUE_TS},       // puissannce apparente maxi de la veille
-    {.label="UMOY1",   .flags=NUMERIQUE_TS},       // tension moyenne ( pas 10 minutes )
-    {.label="EASD01",  .flags=IGNORE},             // index distributeur
-    {.label="EASD02",  .flags=IGNORE},
-    {.label="EASD03",  .flags=IGNORE},
-    {.label="EASD04",  .flags=IGNORE},
-    {.label="EASF01",  .flags=IGNORE},             // index fournisseur
-    {.label="EASF02",  .flags=IGNORE},
-    {.label="EASF03",  .flags=IGNORE},
-    {.label="EASF04",  .flags=IGNORE},
-    {.label="EASF04",  .flags=IGNORE},
-    {.label="EASF05",  .flags=IGNORE},
-    {.label="EASF06",  .flags=IGNORE},
-    {.label="EASF07",  .flags=IGNORE},
-    {.label="EASF08",  .flags=IGNORE},
-    {.label="EASF09",  .flags=IGNORE},
-    {.label="EASF10",  .flags=IGNORE}, 
-    {.label="LTARF",   .flags=IGNORE},      // libellé tarif fournisseur en cours
-    {.label="MSG1",    .flags=IGNORE},      // message court
-    {.label="MSG2",    .flags=IGNORE},      // message ultra-court
-    {.label="NGTF",    .flags=IGNORE},      // nom calendrier fournisseur
-    {.label="NJOURF",  .flags=IGNORE},      // numero jour en cours calendrier fournisseur
-    {.label="NJOURF+1",.flags=IGNORE},      // numero prochain jour calendrier fournisseur
-    {.label="NTARF",   .flags=IGNORE},      // numero index tarifaire en cours
-    {.label="PCOUP",   .flags=IGNORE},      // puissance coupure
-    {.label="PJOURF+1",.flags=IGNORE},      // Profil prochain jour calendrier fournisseur
-    {.label="PREF",    .flags=IGNORE},      // Puissance apparente de référence
-    {.label="PRM",     .flags=IGNORE},      // numéo PRM ou PDL ( référence enedis )
-    {.label="RELAIS",  .flags=IGNORE},      // etat des relais
-    {.label="VTIC",    .flags=IGNORE},      // version de la TIC
-};
-
-static const flags_definition_t TIC_DATA_HISTORIQUE[] = {    
-    {.label="ADCO",    .flags=TEXTE},       // numero de serie du compteur
-    {.label="OPTARIF", .flags=IGNORE},       // energie active soutirée
-    {.label="ISOUSC",  .flags=IGNORE},   // intensite souscrite
-    {.label="BASE",    .flags=NUMERIQUE},   // index d'energie en tarif de base
-    {.label="HCHC",    .flags=NUMERIQUE},   // index d'energie
-    {.label="HCHP",    .flags=NUMERIQUE},   // index d'energie
-    {.label="PTEC",    .flags=IGNORE},       // intensite apparente instantanée
-    {.label="IINST",   .flags=NUMERIQUE},   // intensite apparente instantanée
-    {.label="IMAX",    .flags=IGNORE},   // intensité max
-    {.label="PAPP",    .flags=NUMERIQUE},   // puissance apparente instantanée
-    {.label="MOTDETAT",.flags=IGNORE}
-};
-
-#define TIC_DATA_STANDARD_COUNT   (sizeof(TIC_DATA_STANDARD) / sizeof(TIC_DATA_STANDARD[0]))
-#define TIC_DATA_HISTORIQUE_COUNT (sizeof(TIC_DATA_HISTORIQUE) / sizeof(TIC_DATA_HISTORIQUE[0]))
-
-
 #define TSFRAGMENT_BUFSIZE 8
 static tic_error_t tsfragment_to_int( const char *start, int read_len, int *val, int offset )
 {
@@ -120,9 +42,27 @@ static tic_error_t tsfragment_to_int( const char *start, int read_len, int *val,
     return TIC_OK;
 }
 
-static tic_error_t horodate_to_time_t( const char *horodate, time_t *unix_time)
+// nombre de jours depuis le 1/1/1970 ( calendrier grégorien )
+static int32_t days_from_civil( int32_t y, int32_t m, int32_t d )
+{
+    y -= ( m <= 2 );
+    int32_t era = ( y >= 0 ? y : y - 399 ) / 400;
+    int32_t yoe = y - era * 400;                                       // [0, 399]
+    int32_t doy = ( 153 * ( m + ( m > 2 ? -3 : 9 ) ) + 2 ) / 5 + d - 1;  // [0, 365]
+    int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;               // [0, 146096]
+    return era * 146097 + doe - 719468;
+}
+
+
+#define HORODATE_LEN 13     // SAAMMJJhhmmss
+tic_error_t horodate_to_time_t( const char *horodate, time_t *unix_time)
 {
     //ESP_LOGD( TAG, "horodate_to_time_t(%s)", horodate  );
+    if( strlen( horodate ) != HORODATE_LEN )
+    {
+        ESP_LOGE( TAG, "horodate '%s' invalide", horodate );
+        return TIC_ERR_BAD_DATA;
+    }
 
     struct tm tm;
 
@@ -161,13 +101,20 @@ static tic_error_t horodate_to_time_t( const char *horodate, time_t *unix_time)
     err = tsfragment_to_int( &(horodate[11]), 2, &(tm.tm_sec), 0 );
     if( err != TIC_OK ) { return err; }
 
-    // pour le debug
-    char timebuf[60];
-    strftime( timebuf, sizeof(timebuf), "%Y-%m-%d %H:%M:%S", &tm );
-    //ESP_LOGD( TAG, "horodate decodéee %s", timebuf );
+    if( unix_time == NULL )
+    {
+        return TIC_OK;
+    }
 
-    // renvoie le timestamp unix sur le pointeur fourni
-    if( unix_time != NULL )
+    // saison connue : heure légale française = UTC+1 en hiver, UTC+2 en été
+    // calcul direct, mktime() consulte la timezone à chaque appel
+    if( tm.tm_isdst >= 0 )
+    {
+        *unix_time = (time_t)days_from_civil( tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday ) * 86400
+                     + tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec
+                     - ( tm.tm_isdst ? 7200 : 3600 );
+    }
+    else
     {
         *unix_time = mktime( &tm );
     }
@@ -175,51 +122,44 @@ static tic_error_t horodate_to_time_t( const char *horodate, time_t *unix_time)
 }
 
 
-tic_error_t dataset_parse ( const dataset_t *ds, tic_data_t *data )
+tic_error_t dataset_parse ( const tic_frame_t *frame, tic_data_t *data )
 {
     // valeurs par défaut
     memset( data, 0 ,sizeof(*data) );
     data->horodate = time(NULL);
 
-    char *strtol_end;
     tic_error_t err = TIC_OK;
 
-    // mode TIC ( par défaut historique sauf si label VTIC présent )
-    data->mode = TIC_MODE_HISTORIQUE;
-    const dataset_t* ds_vtic = dataset_find(ds, LABEL_VTIC);
-    if( ds_vtic && strncmp( ds_vtic->valeur, TIC_V2, sizeof(*TIC_V2) ) )
-    {
-        data->mode = TIC_MODE_STANDARD;
-    }
+    // mode TIC du decodeur ( VTIC est IGNORE et n'est plus copié dans la trame )
+    data->mode = frame->mode;
+    data->stx_us = frame->stx_us;
 
     // identifiant compteur
-    const dataset_t* ds_id = dataset_find_deux( ds, LABEL_ADCO, LABEL_ADSC );
+    const dataset_t* ds_id = dataset_find_deux( frame, TIC_LABEL_ADCO, TIC_LABEL_ADSC );
     if ( ds_id )
     {
-        strncpy( data->id_compteur, ds_id->valeur, sizeof(data->id_compteur) );
+        strncpy( data->id_compteur, dataset_valeur( frame, ds_id ), sizeof(data->id_compteur) - 1 );
+        data->id_compteur[sizeof(data->id_compteur) - 1] = '\0';
     }
     else
     {
         ESP_LOGW( TAG, "identifiant compteur absent (ADSC ou ADCO)");
-        strncpy( data->id_compteur, MISSING_ID, sizeof(data->id_compteur) );
+        strncpy( data->id_compteur, MISSING_ID, sizeof(data->id_compteur) - 1 );
+        data->id_compteur[sizeof(data->id_compteur) - 1] = '\0';
         err = TIC_ERR_MISSING_DATA;
     }
 
     // index d'energie active
-    const dataset_t* ds_index = dataset_find_deux( ds, LABEL_BASE, LABEL_EAST );
-    if( ds_index )
+    const dataset_t* ds_index = dataset_find_deux( frame, TIC_LABEL_BASE, TIC_LABEL_EAST );
+    if( ds_index && ds_index->type == TIC_TYPE_ENTIER )
     {
-        int32_t index = strtol( ds_index->valeur, &strtol_end, 10);
-        if( *strtol_end == '\0')
-        {
-            data->index_energie = index;
-        }
-        else
-        {
-            ESP_LOGE( TAG, "erreur strtol() sur valeur EAST ou BASE '%s'", ds_index->valeur );
-            err =TIC_ERR_BAD_DATA;
-        }
+        data->index_energie = ds_index->val.entier;
     } 
+    else if( ds_index )
+    {
+        ESP_LOGE( TAG, "valeur EAST ou BASE invalide '%s'", dataset_valeur( frame, ds_index ) );
+        err = TIC_ERR_BAD_DATA;
+    }
     else
     {
         ESP_LOGW( TAG, "index d'energie active soutirée absent (BASE ou EAST)" );
@@ -227,19 +167,15 @@ tic_error_t dataset_parse ( const dataset_t *ds, tic_data_t *data )
     }
 
     // puissance instantanée apparente
-    const dataset_t* ds_papp = dataset_find_deux( ds, LABEL_PAPP, LABEL_SINSTS );
-    if( ds_papp )
+    const dataset_t* ds_papp = dataset_find_deux( frame, TIC_LABEL_PAPP, TIC_LABEL_SINSTS );
+    if( ds_papp && ds_papp->type == TIC_TYPE_ENTIER )
     {
-        int32_t papp = strtol( ds_papp->valeur, &strtol_end, 10);
-        if( *strtol_end == '\0')
-        {
-            data->puissance_app = papp;
-        }
-        else
-        {
-            ESP_LOGE( TAG, "erreur strtol() sur valeur PAPP ou SINSTS '%s'", ds_papp->valeur );
-            err = TIC_ERR_BAD_DATA;
-        }
+        data->puissance_app = ds_papp->val.entier;
+    }
+    else if( ds_papp )
+    {
+        ESP_LOGE( TAG, "valeur PAPP ou SINSTS invalide '%s'", dataset_valeur( frame, ds_papp ) );
+        err = TIC_ERR_BAD_DATA;
     }
     else
     {
@@ -249,13 +185,12 @@ tic_error_t dataset_parse ( const dataset_t *ds, tic_data_t *data )
 
     // si présente, l'horodate linky remplace l'heure du système
     // pas d'erreur MISSING_DATA sur l'horodate car non disponible en mode historique
-    const dataset_t *ds_horodate = dataset_find( ds, LABEL_DATE );
+    const dataset_t *ds_horodate = dataset_find( frame, TIC_LABEL_DATE );
     if ( ds_horodate )
     {
-        time_t hd;
-        if( horodate_to_time_t( ds_horodate->horodate, &hd) == TIC_OK )
+        if( ds_horodate->ts != 0 )
         {
-            data->horodate = hd;
+            data->horodate = ds_horodate->ts;
         }
         else
         {
@@ -266,231 +201,195 @@ tic_error_t dataset_parse ( const dataset_t *ds, tic_data_t *data )
 }
 
 
-static tic_error_t flags_lookup ( const tic_char_t *etiquette, 
-                                  const flags_definition_t *defs,
-                                  size_t defs_len, 
-                                  tic_dataset_flags_t *out_flags )
+tic_error_t dataset_print( const tic_frame_t *frame )
 {
-    assert(out_flags);
-    for( size_t i=0; i< defs_len; i++ )
+    // ESP_LOGD( TAG, "print_datasets()");
+    char flags_str[3];
+    const dataset_t *ds = dataset_first( frame );
+    while( ds != NULL )
     {
-        if( strncmp( defs[i].label, etiquette, TIC_SIZE_ETIQUETTE ) == 0 )
+        flags_str[0]= '.';
+        flags_str[1]= '.';
+        flags_str[2]=0;    // null-terminated
+        if( ds->flags & TIC_DS_PUBLISHED )
         {
-            *out_flags = defs[i].flags;
-            return TIC_OK;
+            flags_str[0]= ( ds->type == TIC_TYPE_ENTIER ) ? 'N' : 'S';
+            if( ds->flags & TIC_DS_HAS_TIMESTAMP )
+                flags_str[1]= 'H';
         }
+        ESP_LOGD( TAG, "%8.8s %s %s %s", dataset_etiquette( frame, ds ), flags_str, 
+                  dataset_horodate( frame, ds ), dataset_valeur( frame, ds ) );
+        ds = dataset_next( frame, ds );
     }
-    return TIC_ERR_UNKNOWN_DATA;
+    return TIC_OK;
 }
 
-/// @brief renvoie les attributs texte/numerique et avec/sans horodate pour une donnée TIC
-/// @param etiquette nom de la donnée
-/// @param mode utiliser la table standard ou historique ( ou 0 pour chercher dans toutes les tables)
-/// @param out_flags resultat
-/// @return TIC_OK si l'etiquette est trouvée, TIC_ERR_UNKNOWN_DATA sinon
-tic_error_t dataset_flags_definition ( const tic_char_t *etiquette, tic_mode_t mode, tic_dataset_flags_t *out_flags)
-{
-    if ((!mode) || (mode == TIC_MODE_HISTORIQUE))
-    {
-        if( flags_lookup (etiquette, TIC_DATA_HISTORIQUE, TIC_DATA_HISTORIQUE_COUNT, out_flags) == TIC_OK )
-        {
-            return TIC_OK;
-        }
-    }
 
-    if( (!mode) || (mode == TIC_MODE_STANDARD))
-    {
-        if (flags_lookup (etiquette, TIC_DATA_STANDARD, TIC_DATA_STANDARD_COUNT, out_flags) == TIC_OK)
-        {
-            return TIC_OK;
-        }
-    }
-    return TIC_ERR_UNKNOWN_DATA;
+// vide la trame : tous les datasets sont libérés en une fois
+void frame_clear( tic_frame_t *frame )
+{
+    frame->nb_datasets = 0;
+    frame->nb_inconnus = 0;
+    frame->buf_used = 0;
+    frame->nb_rejets = 0;
+    frame->delta = 0;
+    frame->stx_us = 0;
+    memset( frame->present, 0, sizeof(frame->present) );
 }
 
 
-uint32_t dataset_count( dataset_t *dataset )
+static inline bool is_present( const tic_frame_t *frame, size_t idx )
 {
-    uint32_t nb = 0;
-    while ( dataset != NULL )
-    {
-        nb++;
-        dataset = dataset->next;
-    }
-    return nb;
+    return frame->present[idx / 32] & (1UL << (idx % 32));
 }
 
 
-tic_error_t dataset_print( const dataset_t *ds )
+// copie len caractères dans le buffer de la trame, avec un \0 final
+static tic_error_t slice_store( tic_frame_t *frame, const tic_char_t *str, size_t len, tic_slice_t *slice )
 {
-    // ESP_LOGD( TAG, "print_datasets()");
-    char flags_str[3];
-    while( ds != NULL )
+    if( len > UINT8_MAX || frame->buf_used + len + 1 > TIC_FRAME_BUF_SIZE )
     {
-        flags_str[0]= '.';
-        flags_str[1]= '.';
-        flags_str[2]=0;    // null-terminated
-        if( ds->flags & TIC_DS_PUBLISHED )
-        {
-            flags_str[0]= ( ds->flags & TIC_DS_NUMERIQUE ) ? 'N' : 'S';
-            if( ds->flags & TIC_DS_HAS_TIMESTAMP )
-                flags_str[1]= 'H';
-        }
-        ESP_LOGD( TAG, "%8.8s %s %s %s", ds->etiquette, flags_str, ds->horodate, ds->valeur );
-        ds = ds->next;
+        ESP_LOGE( TAG, "Buffer de la trame plein (TIC_FRAME_BUF_SIZE=%d)", TIC_FRAME_BUF_SIZE );
+        return TIC_ERR_OVERFLOW;
     }
+    slice->off = frame->buf_used;
+    slice->len = len;
+    memcpy( &(frame->buf[frame->buf_used]), str, len );
+    frame->buf[frame->buf_used + len] = '\0';
+    frame->buf_used += len + 1;
     return TIC_OK;
 }
 
 
-// Statically allocate and initialize the spinlock
-//static portMUX_TYPE my_spinlock = portMUX_INITIALIZER_UNLOCKED;
-
-dataset_t * dataset_alloc()
+dataset_t * dataset_new( tic_frame_t *frame, tic_label_id_t label,
+                         const tic_char_t *etiquette, size_t etiquette_len,
+                         const tic_char_t *horodate, size_t horodate_len,
+                         const tic_char_t *valeur, size_t valeur_len )
 {
-//    ESP_LOGD( TAG, "datasets_alloc()");
+    // emplacement de l'etiquette, ou zone des inconnus si etiquette inconnue ou déjà reçue
+    size_t idx;
+    if( label < TIC_LABEL_COUNT && !is_present( frame, label ) )
+    {
+        idx = label;
+    }
+    else if( frame->nb_inconnus < TIC_FRAME_MAX_INCONNUS )
+    {
+        idx = TIC_LABEL_COUNT + frame->nb_inconnus;
+    }
+    else
+    {
+        ESP_LOGE( TAG, "Trop de datasets inconnus dans une trame (TIC_FRAME_MAX_INCONNUS=%d)", TIC_FRAME_MAX_INCONNUS );
+        return NULL;
+    }
 
-    dataset_t *ds =  calloc(1, sizeof(dataset_t));
+    // en cas d'erreur la place prise dans le buffer est rendue
+    uint16_t buf_used = frame->buf_used;
+    dataset_t *ds = &(frame->datasets[idx]);
+    memset( ds, 0, sizeof(*ds) );
+    ds->label = label;
 
-    // juste pour le debug
-    /*
-    if( ds!=NULL )
+    if(    (slice_store( frame, etiquette, etiquette_len, &(ds->etiquette) ) != TIC_OK)
+        || (slice_store( frame, valeur, valeur_len, &(ds->valeur) ) != TIC_OK)
+        || (horodate && slice_store( frame, horodate, horodate_len, &(ds->horodate) ) != TIC_OK) )
     {
-        taskENTER_CRITICAL(&my_spinlock);
-        s_allocated_datasets += 1;
-        taskEXIT_CRITICAL(&my_spinlock);
+        frame->buf_used = buf_used;
+        return NULL;
+    }
+
+    // conversion unique de la valeur, les consommateurs lisent ds->val et ds->ts
+    ds->type = label_type( label );
+    if( label_parse_value( label, valeur, valeur_len, &(ds->val) ) != TIC_OK )
+    {
+        ESP_LOGW( TAG, "Valeur '%s' invalide pour %s, conservée comme texte", dataset_valeur( frame, ds ), dataset_etiquette( frame, ds ) );
+        ds->type = TIC_TYPE_TEXTE;
+    }
+    time_t ts;
+    if( horodate && horodate_to_time_t( dataset_horodate( frame, ds ), &ts ) == TIC_OK )
+    {
+        ds->ts = ts;
     }
-    */
     return ds;
 }
 
 
-void dataset_free( dataset_t *ds )
+const tic_char_t * dataset_etiquette( const tic_frame_t *frame, const dataset_t *ds )
 {
-    /*
-    ESP_LOGD( TAG, "dataset_free(%p)", ds );
-    //int32_t nb_init = dataset_count(ds);
-    //int32_t nb_alloc_before = 0;
-    //nb_alloc_before = s_allocated_datasets;
-    dataset_t *ds_init = ds;   // juste pour le log_debug
-    */
-
-    int32_t nb_free = 0;
-    while ( ds != NULL )
-    {
-        dataset_t *tmp = ds;
-        ds = ds->next;
-        free( tmp );
-//        s_allocated_datasets -= 1;
-        nb_free += 1;
-    }
-
-    // juste pour le debug
-    /*
-    taskENTER_CRITICAL(&my_spinlock);
-    s_allocated_datasets -= nb_free;
-    taskEXIT_CRITICAL(&my_spinlock);
-    ESP_LOGD( TAG, "dataset_free(%p) %"PRIi32"/%"PRIi32" libérés. Reste %"PRIi32"/%"PRIi32" datasets alloues", ds_init, nb_free, nb_init, s_allocated_datasets, nb_alloc_before );
-    */
+    return &(frame->buf[ds->etiquette.off]);
 }
 
+const tic_char_t * dataset_horodate( const tic_frame_t *frame, const dataset_t *ds )
+{
+    return ds->horodate.len ? &(frame->buf[ds->horodate.off]) : "";
+}
 
-dataset_t* dataset_insert( dataset_t *sorted, dataset_t *ds)
+const tic_char_t * dataset_valeur( const tic_frame_t *frame, const dataset_t *ds )
 {
-    assert( ds != NULL );           // l'insertion de NULL est invalide
-    assert( ds->next == NULL );     // ds doit être un element isolé, le ptr sur le suivant doit rester chez l'appelant
+    return &(frame->buf[ds->valeur.off]);
+}
 
-    dataset_t *item = sorted;
 
-    while( item != NULL )
+// index du 1er dataset présent à partir de idx, TIC_FRAME_MAX_DATASETS si aucun
+static size_t next_present( const tic_frame_t *frame, size_t idx )
+{
+    while( idx < TIC_FRAME_MAX_DATASETS )
     {
-        if( strcmp( ds->etiquette, item->etiquette ) < 0 )
-        {
-            // ds est plus petit que l'élément courant,
-            assert( item == sorted ); // impossible sauf pour le premier element de la liste triée
-            ds->next = item;          //  insere avant
-            sorted = ds;
-            break;
-        }
-        if ( (item->next == NULL) || (strcmp( ds->etiquette, item->next->etiquette ) <= 0 ) )
+        uint32_t word = frame->present[idx / 32] >> (idx % 32);
+        if( word != 0 )
         {
-            // ds est plus petit que l'élément suivant (ou pas d'élement suivant)
-            ds->next = item->next;    // insere après
-            item->next = ds;
-            break;
+            return idx + __builtin_ctzl( word );
         }
-        item = item->next;
+        idx = (idx / 32 + 1) * 32;      // mot suivant
     }
+    return TIC_FRAME_MAX_DATASETS;
+}
 
-    if( sorted == NULL )
-    {
-        //ESP_LOGD( TAG, "la liste triée est vide, renvoie %s", ds->etiquette );
-        sorted = ds;
-    }
-    return sorted;
+
+const dataset_t * dataset_first( const tic_frame_t *frame )
+{
+    size_t idx = next_present( frame, 0 );
+    return (idx < TIC_FRAME_MAX_DATASETS) ? &(frame->datasets[idx]) : NULL;
 }
 
-// ajoute ds après le dernier elements de append_to
-dataset_t * dataset_append( dataset_t *append_to, dataset_t*ds )
+const dataset_t * dataset_next( const tic_frame_t *frame, const dataset_t *ds )
 {
-    // impossible d'ajouter au pointeur null alors on renvoie juste ds
-    if( append_to == NULL )
-    {
-        return ds;
-    }
-    // cherche le dernier element de append_to
-    dataset_t *tail = append_to;
-    while ( tail->next != NULL )
-    {
-        tail=tail->next;
-    }
-    tail->next = ds;     // ajoute ds
-    return append_to;
+    size_t idx = next_present( frame, (ds - frame->datasets) + 1 );
+    return (idx < TIC_FRAME_MAX_DATASETS) ? &(frame->datasets[idx]) : NULL;
 }
 
 
-dataset_t * dataset_sort(dataset_t *ds)
+void dataset_insert( tic_frame_t *frame, dataset_t *ds )
 {
-    dataset_t * sorted = NULL;
-    dataset_t * ds_next = NULL;
+    assert( ds != NULL );               // l'insertion de NULL est invalide
 
-    while( ds != NULL )
-    {
-        // copie le ptr vers l'item suivant car ds->next va être modifié lors de son insertion dans 'sorted'
-        ds_next = ds->next;
-        ds->next=NULL;
+    size_t idx = ds - frame->datasets;
+    assert( !is_present( frame, idx ) );  // ds doit venir de dataset_new()
 
-        sorted = dataset_insert( sorted, ds );
-        ds = ds_next;
+    frame->present[idx / 32] |= (1UL << (idx % 32));
+    frame->nb_datasets++;
+    if( idx >= TIC_LABEL_COUNT )
+    {
+        frame->nb_inconnus++;
     }
-    return sorted;
 }
 
 
-const dataset_t* dataset_find( const dataset_t *ds, const char *etiquette )
+uint8_t dataset_count( const tic_frame_t *frame )
 {
-    while( ds != NULL )
-    {
-        if( strncmp( ds->etiquette, etiquette, TIC_SIZE_ETIQUETTE ) == 0 )
-        {
-            return ds;
-        }
-        ds = ds->next;
-    }
-    return NULL;
+    return frame->nb_datasets;
 }
 
-const dataset_t* dataset_find_deux( const dataset_t *ds, const char *label1, const char* label2 )
+
+const dataset_t* dataset_find( const tic_frame_t *frame, tic_label_id_t label )
 {
-    while( ds != NULL )
+    if( label >= TIC_LABEL_COUNT || !is_present( frame, label ) )
     {
-        //ESP_LOGD( TAG, "dataset_find_deux() : ds->etiquette=%s", ds->etiquette);
-        if(   (strncmp( ds->etiquette, label1, TIC_SIZE_ETIQUETTE ) == 0)
-           || (strncmp( ds->etiquette, label2, TIC_SIZE_ETIQUETTE ) == 0) )
-        {
-            return ds;
-        }
-        ds = ds->next;
+        return NULL;
     }
-    return NULL;
+    return &(frame->datasets[label]);
+}
+
+const dataset_t* dataset_find_deux( const tic_frame_t *frame, tic_label_id_t label1, tic_label_id_t label2 )
+{
+    const dataset_t *ds = dataset_find( frame, label1 );
+    return ds ? ds : dataset_find( frame, label2 );
 }
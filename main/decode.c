@@ -2,415 +2,107 @@
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/stream_buffer.h"
 #include "freertos/queue.h"
+#include "esp_timer.h"
 #include "esp_log.h"
 
 #include "tic_types.h"
-#include "dataset.h"
+#include "decoder.h"
 #include "decode.h"
+#include "stx_clock.h"
+#include "frame_pool.h"
 #include "process.h"
 #include "event_loop.h"
 
 static const char *TAG = "decode.c";
 
-#define CHAR_STX   0x02    //   start of text - début d'une trame
-#define CHAR_ETX   0x03    //   end of text - fin d'une trame
-#define CHAR_CR    '\r'
-#define CHAR_LF    '\n'
-#define CHAR_SPACE ' '
-#define CHAR_TAB   '\t'
+// buffer circulaire préalloué entre uart_rcv_task et tic_decode_task
+// 2048 bytes = ~2s de réception en mode standard
+#define INCOMING_BUFFER_SIZE  2048
 
-#define TIC_SEPARATOR_INCONNU     0x00
-#define TIC_SEPARATOR_HISTORIQUE  CHAR_SPACE
-#define TIC_SEPARATOR_STANDARD    CHAR_TAB
+// taille des lectures dans le stream buffer par tic_decode_task
+// avec la reception par trame, une trame complète est decodée en un seul appel à decoder_input()
+#if CONFIG_TIC_UART_FRAME_WAKEUP
+#define DECODE_READ_SIZE      1280
+#else
+#define DECODE_READ_SIZE      128
+#endif
 
+static StreamBufferHandle_t s_incoming_bytes = NULL;
 
-// alias pour les tailles de buffers
-#define TIC_SIZE_BUF0 TIC_SIZE_ETIQUETTE
-#define TIC_SIZE_BUF1 TIC_SIZE_VALUE
-#define TIC_SIZE_BUF2 TIC_SIZE_VALUE
-#define TIC_SIZE_BUF3 TIC_SIZE_CHECKSUM
+// mode TIC des derniers bytes reçus, mis à jour par uart_rcv_task
+static volatile tic_mode_t s_incoming_mode = TIC_MODE_INCONNU;
 
-#define TIC_MAX_DATASETS 99
+// compteurs pour dimensionner INCOMING_BUFFER_SIZE
+// modifiés uniquement par uart_rcv_task (un seul écrivain)
+static decode_stats_t s_stats = {0};
 
-#define INCOMING_QUEUE_SIZE  10
-static QueueHandle_t s_incoming_bytes = NULL;
+// heure de réception des STX, de uart_rcv_task vers tic_decode_task, voir stx_clock.h
+#define STX_TIMES_QUEUE_LEN   16
+#define CHAR_STX              0x02
 
-typedef struct {
-    tic_char_t *buf;
-    size_t len;
-    tic_mode_t mode;
-} tic_bytes_t;
-
-
-// tic_frame_s contient les données d'une trame en cours de réception
-typedef struct tic_decoder_s {
-    
-    // mode historique ou standard
-    tic_mode_t mode;
-    tic_char_t sep;
-
-    dataset_t *datasets;         // linked list des datasets complets reçus
-
-    uint8_t stx_received;  // caractere start of frame recu ?
-
-
-    // buffers pour le dataset en cours de reception
-    tic_char_t buf0[TIC_SIZE_BUF0];   // etiquette
-    tic_char_t buf1[TIC_SIZE_BUF1];   // horodate ou valeur
-    tic_char_t buf2[TIC_SIZE_BUF2];   // valeur ou checksum reçu
-    tic_char_t buf3[TIC_SIZE_BUF3];   // checksum reçu ou NULL
-
-    // selecteur du buffer courant
-    tic_char_t *cur_buf;
-    size_t cur_buf_size;
-} tic_decoder_t;
-
-
-static void reset_decoder( tic_decoder_t *td )
-{
-    ESP_LOGD( TAG, "reset_decoder()");
-    // conserve mode et separateur
-
-    // desalloue les datasets
-    dataset_free( td->datasets );
-    td->datasets = NULL;
-
-    // met à 0 toutes les variables et buffers 
-    td->stx_received = 0;
-    memset (td->buf0, 0 , sizeof(td->buf0));
-    memset (td->buf1, 0 , sizeof(td->buf1));
-    memset (td->buf2, 0 , sizeof(td->buf2));
-    memset (td->buf3, 0 , sizeof(td->buf3));
-    td->cur_buf = td->buf0;
-    td->cur_buf_size = sizeof(td->buf0);
-}
-
-
-static tic_error_t decode_dataset_start( tic_decoder_t *td )
-{
-    //ESP_LOGD( TAG, "dataset_start()");
-
-    // limite le nombre de datasets dans une trame
-    if( dataset_count( td->datasets ) >= TIC_MAX_DATASETS )
-    {
-        ESP_LOGE(TAG, "Trop de datasets dans une trame (TIC_MAX_DATASETS=%d)", TIC_MAX_DATASETS );
-        return TIC_ERR_OVERFLOW;
-    }
-
-    // clear buffers 
-    memset( td->buf0, 0, TIC_SIZE_BUF0 );
-    memset( td->buf1, 0, TIC_SIZE_BUF1 );
-    memset( td->buf2, 0, TIC_SIZE_BUF2 );
-    memset( td->buf3, 0, TIC_SIZE_BUF3 );
- 
-    // prepare la réception sur le 1r buffer
-    td->cur_buf = td->buf0;
-    td->cur_buf_size = TIC_SIZE_BUF0;
-    return TIC_OK;
-}
-
-
-// ajoute chaque caractere de la chaine buf à la somme s1
-// TODO : ajouter un parametre avec la taille max du buffer
-static void addbuf( uint32_t *s1, const tic_char_t *buf )
-{
-    const tic_char_t *p = buf;
-    while( *p != '\0' )
-    {
-        *s1 += *p;
-        p++;
-    }
-}
-
-
-static void tic_decoder_debug_state( const tic_decoder_t *td )
-{
-    ESP_LOGI( TAG, "mode=%d, sep=%#02x", td->mode, td->sep);
-    ESP_LOGI (TAG, "stx_received=%d", td->stx_received);
-    ESP_LOGI( TAG, "cur_buf=%p cur_buf_size=%d", td->cur_buf, td->cur_buf_size );
-    ESP_LOGI( TAG, "buf0: [%s] (addr %p len %d)", td->buf0, td->buf0, strlen(td->buf0) );
-    ESP_LOGI( TAG, "buf1: [%s] (addr %p len %d)", td->buf1, td->buf1, strlen(td->buf1) );
-    ESP_LOGI( TAG, "buf2: [%s] (addr %p len %d)", td->buf2, td->buf2, strlen(td->buf2) );
-    ESP_LOGI( TAG, "buf3: [%s] (addr %p len %d)", td->buf3, td->buf3, strlen(td->buf3) );
-}
-
-
-static tic_error_t decode_dataset_end( tic_decoder_t *td ) {
-    //ESP_LOGD( TAG, "dataset_end()");
-
-    tic_char_t *buf_etiquette, *buf_horodate, *buf_valeur, *buf_checksum;
-
-    if( td->buf3[0] != '\0' )          // dataset avec horodate, 4 elements
-    {
-        buf_etiquette = td->buf0;
-        buf_horodate  = td->buf1;
-        buf_valeur    = td->buf2;
-        buf_checksum  = td->buf3;
-    } 
-    else                          // dataset sans horodate, 3 elements
-    {
-        buf_etiquette = td->buf0;
-        buf_horodate  = NULL;
-        buf_valeur    = td->buf1;
-        buf_checksum  = td->buf2;
-    }
-
-    // verifie que le checksum reçu est un caractere unique
-    size_t checksum_len = strlen(buf_checksum);
-    if( checksum_len != 1 )
-    {
-        ESP_LOGE( TAG, "Checksum reçu [%s] a une longueur %d differente de 1", buf_checksum, checksum_len );
-    }
-
-    // calcule le checksum
-    uint32_t s1 = 0;
-    addbuf( &s1, buf_etiquette );
-    s1 += td->sep;
-    if( buf_horodate != NULL )
-    {
-        addbuf( &s1, buf_horodate );
-        s1 += td->sep;
-    }
-    addbuf( &s1, buf_valeur );
-
-    // le separateur précédant le checksum est compté en mode standard mais pas en mode historique
-    if (td->mode == TIC_MODE_STANDARD)
-    {
-        s1 += td->sep;
-    }
-
-    // vérifie le checksum
-    tic_char_t checksum = ( s1 & 0x3F ) + 0x20;   // voir doc linky enedis 
-    if ( checksum != buf_checksum[0] )
-    {
-        ESP_LOGE( TAG, "Checksum incorrect pour %s. attendu=%#x calculé=%#x  (s1=%#lx)", buf_etiquette, buf_checksum[0], checksum, s1 );
-        //tic_decoder_debug_state( td );
-        return TIC_ERR_BAD_DATA;
-    }
+// durée d'un byte ( start + 7 bits + parité + stop ) en µs
+#define BYTE_US_HISTORIQUE    ( 10 * 1000000 / 1200 )
+#define BYTE_US_STANDARD      ( 10 * 1000000 / 9600 )
 
-    // alloue un nouveau dataset et copie les données 
-    dataset_t *ds = dataset_alloc();
-    if (ds == NULL)
-    {
-        return TIC_ERR_OUT_OF_MEMORY;
-    }
-    strncpy( ds->etiquette, buf_etiquette, TIC_SIZE_ETIQUETTE );
-    strncpy( ds->valeur, buf_valeur, TIC_SIZE_VALUE );
+static QueueHandle_t s_stx_times = NULL;
+static uint32_t s_stream_pos = 0;        // bytes transmis au stream buffer, modifié uniquement par uart_rcv_task
+static stx_clock_t s_stx_clock;          // utilisé uniquement par tic_decode_task
 
-    // horodate en option
-    if( buf_horodate != NULL)
-    {
-        strncpy( ds->horodate, buf_horodate, TIC_SIZE_VALUE );
-    }
-    
-    // ajoute les flags
-    tic_dataset_flags_t flags;
-    if( dataset_flags_definition( ds->etiquette, td->mode, &flags) == TIC_OK )
-    {
-        ds->flags = flags;
-    }
-    else
-    {
-        // Completer tic_flags.c si cette erreur se produit
-        ESP_LOGW( TAG, "Donnee %s inconnue diffusée par la TIC", ds->etiquette);
-    }
+// consommateur des lignes au fil de la réception, fixé avant le lancement de la tâche
+static tic_decoder_handler_t s_handler = {0};
 
-    // ajoute le nouveau dataset à la liste
-    //ds->next = td->datasets;
-    //td->datasets = ds;
-    td->datasets = dataset_insert( td->datasets, ds );
+// decodeur de tic_decode_task, pour les compteurs du mode récupération
+static tic_decoder_t *s_td = NULL;
 
-    // mise à jour afficheur oled
-    //affiche_dataset( td, ds );
 
-    return TIC_OK;
-}
-
-
-static tic_error_t decode_frame_start( tic_decoder_t *td ) 
+// trames du pool pour le decodeur
+static tic_frame_t * decode_frame_alloc( void *ctx )
 {
-    //ESP_LOGD( TAG, "frame_start()" );
-    if( td->datasets != NULL || td->stx_received != 0 )
-    {
-        ESP_LOGE( TAG, "Trame incomplète : STX reçu avant ETX" );
-        return TIC_ERR_INVALID_CHAR;
-    }
-    td->stx_received = 1;
-    return TIC_OK;
+    return frame_alloc();
 }
 
-
-static tic_error_t decode_frame_end( tic_decoder_t *td )
+// trames complètes transmises à process_task, qui les rendra au pool
+static tic_error_t decode_frame_ready( tic_frame_t *frame, void *ctx )
 {
-    //td->datasets = tic_dataset_sort( td->datasets );
-
-    // monitoring sur la console serie
-    //dataset_print( td->datasets );
-    ESP_LOGD( TAG, "Trame de %"PRIi32" datasets reçue", dataset_count(td->datasets) );
-
-    //uint32_t nb = tic_dataset_count( td->datasets );
-    //uint32_t size = tic_dataset_size( td->datasets );
-    //ESP_LOGI( TAG, "Trame de %d datasets %d bytes (%p)", nb, size, td->datasets );
-
-    tic_error_t err = process_receive_datasets( td->datasets );
-    if( err == TIC_OK )
-    {
-        // les datasets devront être free() par le recepteur ( process_task )
-        td->datasets = NULL;
-    }
-    else
+    tic_error_t err = process_receive_frame( frame );
+    if( err != TIC_OK )
     {
         ESP_LOGE( TAG, "Queue pleine : impossible d'envoyer la trame vers process_task " );
     }
-    reset_decoder( td );  // appelle tic_dataset_free( td->datasets )
-
-    // todo -> creer un tache de surveillance de la memoire, ou tester les outils d'analyse ESP
-    ESP_LOGD( TAG, "Free memory: %lu bytes", esp_get_free_heap_size());
-
     return err;
 }
 
 
-static tic_error_t decode_separator( tic_decoder_t *td, const tic_char_t ch )
-{
-    //ESP_LOGD(  TAG, "separator_received" );
-    if ( td->cur_buf == td->buf0 )
-    {
-        //ESP_LOGD(  TAG, "  shift from buf0 (used %d bytes) to buf1", strlen(td->buf0) );
-        td->cur_buf = td->buf1;
-        td->cur_buf_size = TIC_SIZE_BUF1;
-    }
-    else if ( td->cur_buf == td->buf1 )
-    {
-        //ESP_LOGD(  TAG, "  shift from buf1 (used %d bytes) to buf2", strlen(td->buf1) );
-        td->cur_buf = td->buf2;
-        td->cur_buf_size = TIC_SIZE_BUF2;
-    }
-    else if ( td->cur_buf == td->buf2 )
-    {
-        //ESP_LOGD(  TAG, "  shift from buf2 (used %d bytes) to buf3", strlen(td->buf2) );
-        td->cur_buf = td->buf3;
-        td->cur_buf_size = TIC_SIZE_BUF3;
-    }
-    else
-    {
-        ESP_LOGE( TAG, "Données invalides : trop d'élements dans un dataset" );
-        ESP_LOGE( TAG, "cur_buf: %p, buf0: %p, buf1: %p, buf2: %p, buf3: %p", td->cur_buf, td->buf0, td->buf1, td->buf2, td->buf3 );
-        return TIC_ERR_OVERFLOW;
-    }
-    return TIC_OK;
-}
-
-
-static tic_error_t decode_data( tic_decoder_t *td, const tic_char_t ch )
+// heures des STX d'un bloc reçu du stream buffer
+static bool stx_time_source( stx_time_t *t, void *ctx )
 {
-    // nombre de caractères déja reçus
-    size_t pos = strlen( td->cur_buf );
-
-    // cas particulier pour le séparateur 
-    if ( ch == td->sep )
-    {
-        return decode_separator( td, ch );
-    }
-
-    // ajoute le caractère si le buffer n'est pas plein
-    if ( pos < td->cur_buf_size )
-    {
-        td->cur_buf[pos] = ch;
-    }
-    else
-    {
-        ESP_LOGE( TAG, "tic_decoder_t overflow. Buffers trop petits (cur_buf_size=%d)", td->cur_buf_size );
-        tic_decoder_debug_state( td );
-        return TIC_ERR_OVERFLOW;
-    }
-
-    return TIC_OK;
+    // uart_rcv_task envoie l'heure juste après les bytes : attente d'un tick au plus
+    return xQueueReceive( s_stx_times, t, 1 ) == pdTRUE;
 }
 
 
-static tic_error_t decode_char( tic_decoder_t *td, const tic_char_t ch )  {
-
-    // ESP_LOGD( TAG, "process_char() : '%c'", ch );
-    tic_error_t ret = TIC_OK;
-
-    // ignore toutes les données tant que STX n'est pas reçu
-    if ( (ch != CHAR_STX) && (td->stx_received == 0) )
-    {
-        //ESP_LOGD( TAG, "Attente début de trame - caractère '%c' ignoré ", ch );
-        return ret;
-    }
-
-    switch ( ch ) { 
-        case CHAR_STX:
-            // start of frame - reset state machine & buffers
-            ret = decode_frame_start( td );
-            break;
-        case CHAR_ETX:
-            // end of frame - send event or signal to antoher task 
-            ret = decode_frame_end( td );
-            break;
-        case CHAR_LF:
-            // start of a dataset - reset buffers and flags
-            ret = decode_dataset_start( td );
-            break;
-        case CHAR_CR:
-            // end of dataset 
-            ret = decode_dataset_end( td );
-            break;
-        default:
-            // autres caractères : label, timestamp, value ou separateur
-            ret = decode_data( td, ch );
-    }
-    return ret;
-}
-
-
-static tic_error_t decode_raw_data( tic_decoder_t* td, const tic_char_t *buf, size_t len )
+// uart_rcv_task : heure de réception des STX transmis ( les sent 1ers bytes ),
+// le dernier des len bytes vient d'être reçu
+static void stamp_stx( const tic_char_t *buf, size_t sent, size_t len, tic_mode_t mode )
 {
-    assert ((td->mode == TIC_MODE_HISTORIQUE) || (td->mode!=TIC_MODE_HISTORIQUE));
-    tic_error_t err = TIC_OK;
-    uint32_t i;
-    for( i=0; ( err==TIC_OK && i<len ) ; i++ )
-    {
-        err = decode_char( td, buf[i] );
-    }
-    return err;
-}
-
-
-static tic_error_t decode_set_mode( tic_decoder_t* td, tic_mode_t mode )
-{
-
-    if ((mode != TIC_MODE_HISTORIQUE) && (mode!=TIC_MODE_STANDARD) )
-    {
-        ESP_LOGW( TAG, "decode_set_mode( %d )", mode);
-    }
-
-
-    if ((td->mode == TIC_MODE_INCONNU) || (mode != td->mode) )
-    {
-        reset_decoder(td);
-    }
-
-    switch(mode)
-    {
-        case TIC_MODE_HISTORIQUE:
-            td->sep = TIC_SEPARATOR_HISTORIQUE;
-            td->mode = TIC_MODE_HISTORIQUE;
-        break;
-        case TIC_MODE_STANDARD:
-            td->sep = TIC_SEPARATOR_STANDARD;
-            td->mode = TIC_MODE_STANDARD;
-        break;
-        default:
-            td->sep = TIC_SEPARATOR_INCONNU;
-            td->mode = TIC_MODE_INCONNU;
-            ESP_LOGE (TAG, "mode tic %0#x inconnu", mode);
-            return TIC_ERR;
+    int64_t now = esp_timer_get_time();
+    int64_t byte_us = ( mode == TIC_MODE_HISTORIQUE ) ? BYTE_US_HISTORIQUE : BYTE_US_STANDARD;
+    for( const tic_char_t *p = memchr( buf, CHAR_STX, sent ); p != NULL;
+         p = memchr( p + 1, CHAR_STX, sent - ( p + 1 - buf ) ) )
+    {
+        size_t after = len - 1 - ( p - buf );       // bytes reçus après STX
+        stx_time_t t = { s_stream_pos + ( p - buf ), now - (int64_t)after * byte_us };
+        if( xQueueSend( s_stx_times, &t, 0 ) != pdTRUE )
+        {
+            // decodeur en retard : l'heure la plus ancienne est abandonnée, son STX aura une heure inconnue
+            stx_time_t old;
+            xQueueReceive( s_stx_times, &old, 0 );
+            xQueueSend( s_stx_times, &t, 0 );
+        }
     }
-    return TIC_OK;
+    s_stream_pos += sent;
 }
 
 
@@ -426,44 +118,53 @@ void tic_decode_task( void *pvParams )
         ESP_LOGD( TAG, "calloc() failed" );
         return;
     }
-    reset_decoder( td );
+    const tic_decoder_io_t io = {
+        .frame_alloc = decode_frame_alloc,
+        .frame_ready = decode_frame_ready,
+        .ctx = NULL
+    };
+    decoder_init( td, &io );
+    decoder_set_handler( td, &s_handler );
+    stx_clock_init( &s_stx_clock );
+    decoder_set_clock( td, stx_clock_next, &s_stx_clock );
+#if CONFIG_TIC_DECODER_SALVAGE
+    decoder_set_salvage( td, true );
+#endif
+    s_td = td;
 
     tic_error_t err;
-    tic_bytes_t packet = {0};
+    static tic_char_t buf[DECODE_READ_SIZE];      // hors de la pile de la tâche
+    size_t len;
 
     for(;;) {
-        free (packet.buf);   // alloué dans uart_events
-        packet.buf=NULL;
-        if( xQueueReceive (s_incoming_bytes, &packet, portMAX_DELAY) != pdPASS )
+        len = xStreamBufferReceive( s_incoming_bytes, buf, sizeof(buf), portMAX_DELAY );
+        if( len == 0 )
         {
-            ESP_LOGE(TAG, "xQueueReceive() failed");
-            continue;
+            continue;   // timeout
         }
 
-        // ignore les packets vides
-        if (packet.len==0 || packet.buf==NULL)
-        {
-            continue;
-        }
+        // heures des STX du bloc, même s'il n'est pas decodé
+        stx_clock_chunk( &s_stx_clock, buf, len, stx_time_source, NULL );
 
         // mode historique ou standard ?
-        err = decode_set_mode(td, packet.mode) != TIC_OK;
+        err = decoder_set_mode( td, s_incoming_mode );
         if( err != TIC_OK )
         {
             continue;
         }
 
-        err = decode_raw_data( td, packet.buf, packet.len );
+        err = decoder_input( td, buf, len );
         if( err != TIC_OK )
         {
             ESP_LOGE(TAG, "tic decoder error (%#0x)", err);
-            reset_decoder( td );
+            decoder_reset( td );
         }
     }
 }
 
 // Appelé par la tâche uart_events.c pour envoyer les bytes reçus
-tic_error_t decode_incoming_bytes( tic_char_t *buf , size_t len, tic_mode_t mode )
+// les bytes sont copiés dans le stream buffer, buf reste la propriété de l'appelant
+tic_error_t decode_incoming_bytes( const tic_char_t *buf , size_t len, tic_mode_t mode )
 {
     if( s_incoming_bytes == NULL )
     {
@@ -471,34 +172,76 @@ tic_error_t decode_incoming_bytes( tic_char_t *buf , size_t len, tic_mode_t mode
         return 0;
     }
 
-    tic_bytes_t packet = {
-        .buf = buf,
-        .len = len,
-        .mode = mode
-    };
-    if (xQueueSend (s_incoming_bytes, &packet, portMAX_DELAY) != pdPASS)
+    s_incoming_mode = mode;
+
+    // pas d'attente : si le decodeur ne suit pas, les bytes en trop sont perdus
+    size_t sent = xStreamBufferSend( s_incoming_bytes, buf, len, 0 );
+    s_stats.bytes_received += len;
+    stamp_stx( buf, sent, len, mode );
+
+    size_t used = INCOMING_BUFFER_SIZE - xStreamBufferSpacesAvailable( s_incoming_bytes );
+    if( used > s_stats.buffer_max_used )
     {
-        ESP_LOGE (TAG, "xQueueSend() failed");
+        s_stats.buffer_max_used = used;
+    }
+
+    if( sent < len )
+    {
+        s_stats.bytes_dropped += (len - sent);
+        s_stats.overruns++;
+        ESP_LOGE( TAG, "stream buffer plein : %zu bytes perdus", len - sent );
         return TIC_ERR_QUEUEFULL;
     }
     return TIC_OK;
 }
 
+tic_error_t decode_set_handler( const tic_decoder_handler_t *handler )
+{
+    if( s_incoming_bytes != NULL )
+    {
+        ESP_LOGE( TAG, "decode_set_handler() doit être appelé avant tic_decode_task_start()" );
+        return TIC_ERR;
+    }
+    s_handler = *handler;
+    return TIC_OK;
+}
+
+void decode_get_stats( decode_stats_t *stats )
+{
+    assert( stats );
+    memcpy( stats, &s_stats, sizeof(*stats) );
+    stats->buffer_size = INCOMING_BUFFER_SIZE;
+    stats->lines_dropped = ( s_td != NULL ) ? s_td->lines_dropped : 0;
+}
+
 // Create a task to decode teleinfo raw bytestream received from uart
 tic_error_t tic_decode_task_start( )
 {
-    // transfere les packets de données depuis l'UART vers le decodeur
-    s_incoming_bytes = xQueueCreate (INCOMING_QUEUE_SIZE, sizeof(tic_bytes_t));
-    if (s_incoming_bytes == NULL)
+    // trames préallouées, remplies par le decodeur et libérées par process_task
+    if( frame_pool_init() != TIC_OK )
+    {
+        return TIC_ERR_APP_INIT;
+    }
+
+    s_stx_times = xQueueCreate( STX_TIMES_QUEUE_LEN, sizeof(stx_time_t) );
+    if (s_stx_times == NULL)
     {
         ESP_LOGE (TAG, "xQueueCreate() failed");
         return TIC_ERR_APP_INIT;
     }
 
+    // transfere les bytes reçus depuis l'UART vers le decodeur
+    s_incoming_bytes = xStreamBufferCreate( INCOMING_BUFFER_SIZE, 1 );
+    if (s_incoming_bytes == NULL)
+    {
+        ESP_LOGE (TAG, "xStreamBufferCreate() failed");
+        return TIC_ERR_APP_INIT;
+    }
+
     if( xTaskCreate(tic_decode_task, "tic_decode_task", 4096, NULL, 12, NULL) != pdPASS )
     {
         ESP_LOGE (TAG, "xTaskCreate() failed");
         return TIC_ERR_APP_INIT;
     }
     return TIC_OK;
-}
\ No newline at end of file
+}
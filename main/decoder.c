@@ -0,0 +1,497 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <stdint.h>
+
+#include "tic_log.h"
+
+#include "tic_types.h"
+#include "dataset.h"
+#include "labels.h"
+#include "decoder.h"
+
+static const char *TAG = "decoder.c";
+
+#define CHAR_STX   0x02    //   start of text - début d'une trame
+#define CHAR_ETX   0x03    //   end of text - fin d'une trame
+#define CHAR_CR    '\r'
+#define CHAR_LF    '\n'
+#define CHAR_SPACE ' '
+#define CHAR_TAB   '\t'
+
+#define TIC_SEPARATOR_INCONNU     0x00
+#define TIC_SEPARATOR_HISTORIQUE  CHAR_SPACE
+#define TIC_SEPARATOR_STANDARD    CHAR_TAB
+
+
+// alias pour les tailles de buffers
+#define TIC_SIZE_BUF0 TIC_SIZE_ETIQUETTE
+#define TIC_SIZE_BUF1 TIC_SIZE_VALUE
+#define TIC_SIZE_BUF2 TIC_SIZE_VALUE
+#define TIC_SIZE_BUF3 TIC_SIZE_CHECKSUM
+
+
+// selectionne le buffer du champ n et remet le curseur au début
+static void select_field( tic_decoder_t *td, uint8_t n )
+{
+    switch( n )
+    {
+        case 0:
+            td->cur_buf = td->buf0;
+            td->cur_buf_size = TIC_SIZE_BUF0;
+            break;
+        case 1:
+            td->cur_buf = td->buf1;
+            td->cur_buf_size = TIC_SIZE_BUF1;
+            break;
+        case 2:
+            td->cur_buf = td->buf2;
+            td->cur_buf_size = TIC_SIZE_BUF2;
+            break;
+        default:
+            td->cur_buf = td->buf3;
+            td->cur_buf_size = TIC_SIZE_BUF3;
+    }
+    td->field = n;
+    td->cur_pos = 0;
+    td->cur_buf[0] = '\0';
+}
+
+
+// prepare la reception d'un nouveau dataset
+static void clear_dataset( tic_decoder_t *td )
+{
+    memset( td->len, 0, sizeof(td->len) );
+    td->buf1[0] = '\0';
+    td->buf2[0] = '\0';
+    td->buf3[0] = '\0';
+    td->sum = 0;
+    td->sum_before_sep = 0;
+    td->label = TIC_LABEL_INCONNU;
+    td->flags = 0;
+    td->skip = 0;
+    td->drop_line = 0;
+    select_field( td, 0 );
+}
+
+
+void decoder_reset( tic_decoder_t *td )
+{
+    ESP_LOGD( TAG, "decoder_reset()");
+    // conserve mode et separateur
+
+    // vide la trame en cours, elle sera réutilisée pour la trame suivante
+    if( td->frame != NULL )
+    {
+        frame_clear( td->frame );
+    }
+
+    // remet à 0 l'état et les buffers 
+    td->stx_received = 0;
+    clear_dataset( td );
+}
+
+
+static tic_error_t decode_dataset_start( tic_decoder_t *td )
+{
+    //ESP_LOGD( TAG, "dataset_start()");
+
+    // prepare la réception sur le 1r buffer
+    clear_dataset( td );
+    return TIC_OK;
+}
+
+
+static void tic_decoder_debug_state( const tic_decoder_t *td )
+{
+    ESP_LOGI( TAG, "mode=%d, sep=%#02x", td->mode, td->sep);
+    ESP_LOGI (TAG, "stx_received=%d", td->stx_received);
+    ESP_LOGI( TAG, "field=%d cur_buf=%p cur_buf_size=%zu cur_pos=%zu", td->field, td->cur_buf, td->cur_buf_size, td->cur_pos );
+    ESP_LOGI( TAG, "buf0: [%s] (addr %p len %zu)", td->buf0, td->buf0, td->len[0] );
+    ESP_LOGI( TAG, "buf1: [%s] (addr %p len %zu)", td->buf1, td->buf1, td->len[1] );
+    ESP_LOGI( TAG, "buf2: [%s] (addr %p len %zu)", td->buf2, td->buf2, td->len[2] );
+    ESP_LOGI( TAG, "buf3: [%s] (addr %p len %zu)", td->buf3, td->buf3, td->len[3] );
+    ESP_LOGI( TAG, "sum=%#"PRIx32" sum_before_sep=%#"PRIx32, td->sum, td->sum_before_sep );
+    ESP_LOGI( TAG, "label=%d flags=%#x skip=%d", td->label, td->flags, td->skip );
+}
+
+
+// termine le champ en cours de reception
+static void close_field( tic_decoder_t *td )
+{
+    td->cur_buf[td->cur_pos] = '\0';
+    td->len[td->field] = td->cur_pos;
+}
+
+
+// identifie l'etiquette dès la fin du 1er champ
+static void identify_label( tic_decoder_t *td )
+{
+    td->label = label_lookup( td->buf0, td->len[0] );
+    if( td->label == TIC_LABEL_INCONNU )
+    {
+        // Completer tic_labels.h si cette erreur se produit
+        // les données inconnues restent dans la trame, sans flags
+        ESP_LOGW( TAG, "Donnee %s inconnue diffusée par la TIC", td->buf0 );
+        return;
+    }
+
+    if( label_flags( td->label, td->mode, &(td->flags) ) == TIC_OK && (td->flags & TIC_DS_PUBLISHED) == 0 )
+    {
+        // la suite du dataset ne sert qu'au checksum
+        td->skip = 1;
+    }
+}
+
+
+static tic_error_t decode_frame_start( tic_decoder_t *td ) 
+{
+    //ESP_LOGD( TAG, "frame_start()" );
+    if( td->stx_received != 0 )
+    {
+        ESP_LOGE( TAG, "Trame incomplète : STX reçu avant ETX" );
+        if( !td->salvage )
+        {
+            return TIC_ERR_INVALID_CHAR;
+        }
+        // mode récupération : la trame tronquée est abandonnée, la suivante commence ici
+        decoder_reset( td );
+    }
+
+    // appelé pour chaque STX, même si la trame est ignorée, pour rester aligné avec l'appelant
+    td->stx_us = td->stx_clock ? td->stx_clock( td->stx_clock_ctx ) : 0;
+
+    // la trame précédente a été transmise au recepteur, en prend une nouvelle
+    if( td->frame == NULL && td->io.frame_alloc != NULL )
+    {
+        td->frame = td->io.frame_alloc( td->io.ctx );
+        if( td->frame == NULL && td->handler.line == NULL )
+        {
+            // la trame est ignorée jusqu'au prochain STX
+            ESP_LOGE( TAG, "Pool de trames vide : trame ignorée" );
+            return TIC_OK;
+        }
+        if( td->frame == NULL )
+        {
+            ESP_LOGE( TAG, "Pool de trames vide : lignes transmises sans assembler la trame" );
+        }
+    }
+    if( td->frame != NULL )
+    {
+        td->frame->mode = td->mode;
+        td->frame->stx_us = td->stx_us;
+    }
+    td->stx_received = 1;
+
+    if( td->handler.frame_start )
+    {
+        td->handler.frame_start( td->mode, td->stx_us, td->handler.ctx );
+    }
+    return TIC_OK;
+}
+
+
+static tic_error_t decode_frame_end( tic_decoder_t *td )
+{
+    if( td->handler.frame_end )
+    {
+        td->handler.frame_end( td->handler.ctx );
+    }
+
+    // decodage sans assemblage des trames
+    tic_error_t err = TIC_OK;
+    if( td->frame == NULL )
+    {
+        decoder_reset( td );
+        return err;
+    }
+
+    // monitoring sur la console serie
+    //dataset_print( td->frame );
+    ESP_LOGD( TAG, "Trame de %d datasets reçue (%d bytes)", dataset_count( td->frame ), td->frame->buf_used );
+
+    err = td->io.frame_ready( td->frame, td->io.ctx );
+    if( err == TIC_OK )
+    {
+        // la trame appartient maintenant au recepteur
+        td->frame = NULL;
+    }
+    else
+    {
+        ESP_LOGE( TAG, "Trame complète non prise en charge, elle est réutilisée" );
+    }
+    decoder_reset( td );
+
+    return err;
+}
+
+
+// mode récupération : écarte la ligne en cours et attend le prochain LF
+static void drop_line( tic_decoder_t *td )
+{
+    td->lines_dropped++;
+    td->drop_line = 1;
+
+    // une ligne IGNORE écartée ne manque pas à la trame publiée
+    bool publiee = ( td->label == TIC_LABEL_INCONNU ) || ( td->flags & TIC_DS_PUBLISHED );
+    if( td->frame == NULL || !publiee )
+    {
+        return;
+    }
+    tic_frame_t *frame = td->frame;
+    if( frame->nb_rejets < TIC_FRAME_MAX_REJETS )
+    {
+        frame->rejets[frame->nb_rejets] = td->label;
+    }
+    if( frame->nb_rejets < UINT8_MAX )
+    {
+        frame->nb_rejets++;
+    }
+}
+
+
+// ******************* lecture par mots ( SWAR ) ******************
+// les delimiteurs STX ETX LF CR TAB et SPACE sont tous <= 0x20 :
+// un mot est testé en une fois et seuls les caractères de contrôle passent par decode_char()
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define TIC_SWAR 1
+#else
+#define TIC_SWAR 0
+#endif
+
+#if UINTPTR_MAX > 0xFFFFFFFFu
+typedef uint64_t tic_word_t;        // hôte 64 bits
+#else
+typedef uint32_t tic_word_t;        // ESP32-C3 ( RISC-V 32 bits )
+#endif
+
+#define WORD_ONES    ((tic_word_t)-1 / 0xFF)         // 0x0101...
+#define WORD_HIGHS   (WORD_ONES * 0x80)              // 0x8080...
+#define WORD_LOW16   ((tic_word_t)-1 / 0xFFFF)       // 0x0001 0001...
+
+static inline tic_word_t load_word( const tic_char_t *p )
+{
+    tic_word_t w;
+    memcpy( &w, p, sizeof(w) );     // lecture non alignée, une seule instruction sur les 2 cibles
+    return w;
+}
+
+// nombre de caractères avant le 1er byte < limit ( limit <= 0x80 )
+static size_t span_length( const tic_char_t *buf, size_t len, uint8_t limit )
+{
+    size_t n = 0;
+#if TIC_SWAR
+    const tic_word_t limits = WORD_ONES * limit;
+    for( ; n + sizeof(tic_word_t) <= len; n += sizeof(tic_word_t) )
+    {
+        tic_word_t w = load_word( &(buf[n]) );
+        // bit 7 levé pour chaque byte < limit ( exact pour le 1er byte trouvé )
+        tic_word_t found = ( w - limits ) & ~w & WORD_HIGHS;
+        if( found )
+        {
+            return n + ( __builtin_ctzll( found ) >> 3 );
+        }
+    }
+#endif
+    while( n < len && (uint8_t)buf[n] >= limit )
+    {
+        n++;
+    }
+    return n;
+}
+
+// somme des bytes, pour le checksum
+static uint32_t span_sum( const tic_char_t *buf, size_t len )
+{
+    uint32_t sum = 0;
+    size_t n = 0;
+#if TIC_SWAR
+    for( ; n + sizeof(tic_word_t) <= len; n += sizeof(tic_word_t) )
+    {
+        tic_word_t w = load_word( &(buf[n]) );
+        // sommes 2 à 2 sur 16 bits, puis addition de toutes les moitiés par multiplication
+        tic_word_t pairs = ( w & ( WORD_LOW16 * 0x00FF ) ) + ( ( w >> 8 ) & ( WORD_LOW16 * 0x00FF ) );
+        sum += (uint32_t)( ( pairs * WORD_LOW16 ) >> ( 8 * sizeof(tic_word_t) - 16 ) );
+    }
+#endif
+    for( ; n < len; n++ )
+    {
+        sum += (uint8_t)buf[n];
+    }
+    return sum;
+}
+
+
+// ajoute une suite de caractères sans delimiteur au champ en cours
+static tic_error_t decode_span( tic_decoder_t *td, const tic_char_t *buf, size_t n )
+{
+    // ligne écartée par le mode récupération
+    if( td->drop_line )
+    {
+        return TIC_OK;
+    }
+
+    // dataset IGNORE : checksum seulement
+    if( td->skip )
+    {
+        td->sum += span_sum( buf, n );
+        td->last_ch = buf[n-1];
+        td->cur_pos += n;
+        return TIC_OK;
+    }
+
+    // garde la place du \0 final, comme decode_data()
+    size_t room = td->cur_buf_size - 1 - td->cur_pos;
+    if( n > room )
+    {
+        memcpy( &(td->cur_buf[td->cur_pos]), buf, room );
+        td->cur_pos += room;
+        ESP_LOGE( TAG, "tic_decoder_t overflow. Buffers trop petits (cur_buf_size=%zu)", td->cur_buf_size );
+        tic_decoder_debug_state( td );
+        if( td->salvage )
+        {
+            drop_line( td );
+            return TIC_OK;
+        }
+        return TIC_ERR_OVERFLOW;
+    }
+    memcpy( &(td->cur_buf[td->cur_pos]), buf, n );
+    td->cur_pos += n;
+    td->sum += span_sum( buf, n );
+    return TIC_OK;
+}
+
+
+// ******************* decodeurs spécialisés par mode ******************
+// decoder_impl.h est compilé une fois par mode : separateur et règle du checksum sont des
+// constantes, decoder_set_mode() ne fait que changer la table de fonctions
+
+struct tic_decoder_ops_s {
+    tic_error_t (*input)( tic_decoder_t *td, const tic_char_t *buf, size_t len );
+    tic_error_t (*input_bytewise)( tic_decoder_t *td, const tic_char_t *buf, size_t len );
+};
+typedef struct tic_decoder_ops_s tic_decoder_ops_t;
+
+// mode historique : separateur SPACE, non compté dans le checksum
+#define IMPL(name)              name##_historique
+#define IMPL_SEP                TIC_SEPARATOR_HISTORIQUE
+#define IMPL_SEP_IN_CHECKSUM    0
+#define IMPL_LIMIT              ( CHAR_SPACE + 1 )
+#include "decoder_impl.h"
+
+// mode standard : separateur TAB, compté dans le checksum
+#define IMPL(name)              name##_standard
+#define IMPL_SEP                TIC_SEPARATOR_STANDARD
+#define IMPL_SEP_IN_CHECKSUM    1
+#define IMPL_LIMIT              CHAR_SPACE
+#include "decoder_impl.h"
+
+
+// mode inconnu : rien n'est decodé tant que decoder_set_mode() n'a pas réussi
+static tic_error_t input_inconnu( tic_decoder_t *td, const tic_char_t *buf, size_t len )
+{
+    ESP_LOGD( TAG, "mode inconnu : %zu bytes ignorés", len );
+    return TIC_ERR_NOT_INITIALIZED;
+}
+
+static const tic_decoder_ops_t ops_inconnu = {
+    .input = input_inconnu,
+    .input_bytewise = input_inconnu,
+};
+
+
+tic_error_t decoder_input( tic_decoder_t* td, const tic_char_t *buf, size_t len )
+{
+    return td->ops->input( td, buf, len );
+}
+
+
+tic_error_t decoder_input_bytewise( tic_decoder_t* td, const tic_char_t *buf, size_t len )
+{
+    return td->ops->input_bytewise( td, buf, len );
+}
+
+
+tic_error_t decoder_set_mode( tic_decoder_t* td, tic_mode_t mode )
+{
+    // appelé avant chaque bloc reçu : rien à faire si le mode ne change pas
+    if( mode == td->mode && mode != TIC_MODE_INCONNU )
+    {
+        return TIC_OK;
+    }
+
+    if ((mode != TIC_MODE_HISTORIQUE) && (mode!=TIC_MODE_STANDARD) )
+    {
+        ESP_LOGW( TAG, "decoder_set_mode( %d )", mode);
+    }
+
+
+    if ((td->mode == TIC_MODE_INCONNU) || (mode != td->mode) )
+    {
+        decoder_reset(td);
+    }
+
+    switch(mode)
+    {
+        case TIC_MODE_HISTORIQUE:
+            td->sep = TIC_SEPARATOR_HISTORIQUE;
+            td->mode = TIC_MODE_HISTORIQUE;
+            td->ops = &ops_historique;
+        break;
+        case TIC_MODE_STANDARD:
+            td->sep = TIC_SEPARATOR_STANDARD;
+            td->mode = TIC_MODE_STANDARD;
+            td->ops = &ops_standard;
+        break;
+        default:
+            td->sep = TIC_SEPARATOR_INCONNU;
+            td->mode = TIC_MODE_INCONNU;
+            td->ops = &ops_inconnu;
+            ESP_LOGE (TAG, "mode tic %0#x inconnu", mode);
+            return TIC_ERR;
+    }
+    return TIC_OK;
+}
+
+
+
+void decoder_init( tic_decoder_t *td, const tic_decoder_io_t *io )
+{
+    assert( io == NULL || (io->frame_alloc && io->frame_ready) );
+    memset( td, 0, sizeof(*td) );
+    if( io != NULL )
+    {
+        td->io = *io;
+    }
+    td->mode = TIC_MODE_INCONNU;
+    td->sep = TIC_SEPARATOR_INCONNU;
+    td->ops = &ops_inconnu;
+    decoder_reset( td );
+}
+
+
+void decoder_set_clock( tic_decoder_t *td, int64_t (*stx_clock)( void *ctx ), void *ctx )
+{
+    td->stx_clock = stx_clock;
+    td->stx_clock_ctx = ctx;
+}
+
+
+void decoder_set_salvage( tic_decoder_t *td, bool enable )
+{
+    td->salvage = enable ? 1 : 0;
+}
+
+
+void decoder_set_handler( tic_decoder_t *td, const tic_decoder_handler_t *handler )
+{
+    if( handler != NULL )
+    {
+        td->handler = *handler;
+    }
+    else
+    {
+        memset( &(td->handler), 0, sizeof(td->handler) );
+    }
+}
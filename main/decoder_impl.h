@@ -0,0 +1,285 @@
+// coeur du decodeur, inclus une fois par mode dans decoder.c
+//
+// à definir avant l'inclusion :
+//   IMPL(name)             nom de la fonction pour ce mode
+//   IMPL_SEP               separateur des champs
+//   IMPL_SEP_IN_CHECKSUM   1 si le separateur précédant le checksum est compté
+//   IMPL_LIMIT             les caractères < IMPL_LIMIT interrompent la lecture par mots
+
+// vérifie le checksum reçu en fin de dataset
+static tic_error_t IMPL(check_sum)( const tic_decoder_t *td, tic_char_t checksum_recu, size_t checksum_len )
+{
+    // verifie que le checksum reçu est un caractere unique
+    if( checksum_len != 1 )
+    {
+        ESP_LOGE( TAG, "Checksum reçu pour %s a une longueur %zu differente de 1", td->buf0, checksum_len );
+    }
+
+    // le separateur précédant le checksum est compté en mode standard mais pas en mode historique
+    uint32_t s1 = td->sum_before_sep;
+#if IMPL_SEP_IN_CHECKSUM
+    s1 += IMPL_SEP;
+#endif
+
+    tic_char_t checksum = ( s1 & 0x3F ) + 0x20;   // voir doc linky enedis 
+    if ( checksum != checksum_recu )
+    {
+        ESP_LOGE( TAG, "Checksum incorrect pour %s. attendu=%#x calculé=%#x  (s1=%#"PRIx32")", td->buf0, checksum_recu, checksum, s1 );
+        //tic_decoder_debug_state( td );
+        return TIC_ERR_BAD_DATA;
+    }
+    return TIC_OK;
+}
+
+
+static tic_error_t IMPL(decode_dataset_end)( tic_decoder_t *td ) {
+    //ESP_LOGD( TAG, "dataset_end()");
+
+    if( (td->field != 2) && (td->field != 3) )
+    {
+        ESP_LOGE( TAG, "Dataset incomplet : %d elements reçus", td->field+1 );
+        return TIC_ERR_BAD_DATA;
+    }
+
+    // dataset IGNORE : checksum seulement, pas de dataset dans la trame
+    if( td->skip )
+    {
+        return IMPL(check_sum)( td, td->last_ch, td->cur_pos );
+    }
+
+    close_field( td );
+
+    tic_char_t *buf_horodate, *buf_valeur, *buf_checksum;
+    size_t horodate_len, valeur_len;
+
+    if( td->field == 3 )          // dataset avec horodate, 4 elements
+    {
+        buf_horodate  = td->buf1;
+        horodate_len  = td->len[1];
+        buf_valeur    = td->buf2;
+        valeur_len    = td->len[2];
+        buf_checksum  = td->buf3;
+    }
+    else                          // dataset sans horodate, 3 elements
+    {
+        buf_horodate  = NULL;
+        horodate_len  = 0;
+        buf_valeur    = td->buf1;
+        valeur_len    = td->len[1];
+        buf_checksum  = td->buf2;
+    }
+
+    tic_error_t err = IMPL(check_sum)( td, buf_checksum[0], td->len[td->field] );
+    if( err != TIC_OK )
+    {
+        return err;
+    }
+
+    // transmet la ligne validée dès son CR, sans attendre la fin de la trame
+    if( td->handler.line )
+    {
+        const tic_line_t line = {
+            .label = td->label,
+            .flags = td->flags,
+            .etiquette = td->buf0,
+            .etiquette_len = td->len[0],
+            .horodate = buf_horodate,
+            .horodate_len = horodate_len,
+            .valeur = buf_valeur,
+            .valeur_len = valeur_len
+        };
+        td->handler.line( &line, td->handler.ctx );
+    }
+
+    // decodage sans assemblage des trames
+    if( td->frame == NULL )
+    {
+        return TIC_OK;
+    }
+
+    // copie les données dans la trame ( horodate en option )
+    dataset_t *ds = dataset_new( td->frame, td->label, td->buf0, td->len[0], buf_horodate, horodate_len, buf_valeur, valeur_len );
+    if (ds == NULL)
+    {
+        return TIC_ERR_OVERFLOW;
+    }
+    ds->flags = td->flags;
+
+    // ajoute le nouveau dataset à la trame
+    dataset_insert( td->frame, ds );
+
+    return TIC_OK;
+}
+
+
+static tic_error_t IMPL(decode_separator)( tic_decoder_t *td, const tic_char_t ch )
+{
+    //ESP_LOGD(  TAG, "separator_received" );
+    if ( td->field >= TIC_NB_FIELDS-1 )
+    {
+        ESP_LOGE( TAG, "Données invalides : trop d'élements dans un dataset" );
+        tic_decoder_debug_state( td );
+        return TIC_ERR_OVERFLOW;
+    }
+
+    // le checksum porte sur les caractères précédant le dernier séparateur
+    td->sum_before_sep = td->sum;
+    td->sum += ch;
+
+    // dataset IGNORE : compte seulement les champs
+    if( td->skip )
+    {
+        td->len[td->field] = td->cur_pos;
+        td->field++;
+        td->cur_pos = 0;
+        return TIC_OK;
+    }
+
+    close_field( td );
+    if( td->field == 0 )
+    {
+        identify_label( td );
+    }
+    select_field( td, td->field+1 );
+    return TIC_OK;
+}
+
+
+static tic_error_t IMPL(decode_data)( tic_decoder_t *td, const tic_char_t ch )
+{
+    // cas particulier pour le séparateur 
+    if ( ch == IMPL_SEP )
+    {
+        return IMPL(decode_separator)( td, ch );
+    }
+
+    // dataset IGNORE : checksum seulement
+    if( td->skip )
+    {
+        td->sum += ch;
+        td->last_ch = ch;
+        td->cur_pos++;
+        return TIC_OK;
+    }
+
+    // ajoute le caractère si le buffer n'est pas plein (garde la place du \0 final)
+    if ( td->cur_pos < td->cur_buf_size-1 )
+    {
+        td->cur_buf[td->cur_pos++] = ch;
+        td->sum += ch;
+    }
+    else
+    {
+        ESP_LOGE( TAG, "tic_decoder_t overflow. Buffers trop petits (cur_buf_size=%zu)", td->cur_buf_size );
+        tic_decoder_debug_state( td );
+        return TIC_ERR_OVERFLOW;
+    }
+
+    return TIC_OK;
+}
+
+
+static tic_error_t IMPL(decode_char)( tic_decoder_t *td, const tic_char_t ch )  {
+
+    // ESP_LOGD( TAG, "process_char() : '%c'", ch );
+    tic_error_t ret = TIC_OK;
+
+    // ignore toutes les données tant que STX n'est pas reçu
+    if ( (ch != CHAR_STX) && (td->stx_received == 0) )
+    {
+        //ESP_LOGD( TAG, "Attente début de trame - caractère '%c' ignoré ", ch );
+        return ret;
+    }
+
+    // ligne écartée : ignore tout jusqu'au prochain LF, STX ou ETX
+    if( td->drop_line && ch != CHAR_LF && ch != CHAR_STX && ch != CHAR_ETX )
+    {
+        return ret;
+    }
+
+    switch ( ch ) { 
+        case CHAR_STX:
+            // start of frame - reset state machine & buffers
+            ret = decode_frame_start( td );
+            break;
+        case CHAR_ETX:
+            // end of frame - send event or signal to antoher task 
+            ret = decode_frame_end( td );
+            break;
+        case CHAR_LF:
+            // start of a dataset - reset buffers and flags
+            ret = decode_dataset_start( td );
+            break;
+        case CHAR_CR:
+            // end of dataset 
+            ret = IMPL(decode_dataset_end)( td );
+            break;
+        default:
+            // autres caractères : label, timestamp, value ou separateur
+            ret = IMPL(decode_data)( td, ch );
+    }
+
+    // erreur dans une ligne : seule la ligne est perdue en mode récupération
+    if( ret != TIC_OK && td->salvage && ch != CHAR_STX && ch != CHAR_ETX )
+    {
+        drop_line( td );
+        ret = TIC_OK;
+    }
+    return ret;
+}
+
+
+static tic_error_t IMPL(input)( tic_decoder_t* td, const tic_char_t *buf, size_t len )
+{
+    tic_error_t err = TIC_OK;
+    size_t i = 0;
+    while( err == TIC_OK && i < len )
+    {
+        // hors trame : seul STX compte
+        if( td->stx_received == 0 )
+        {
+            const tic_char_t *stx = memchr( &(buf[i]), CHAR_STX, len - i );
+            if( stx == NULL )
+            {
+                break;
+            }
+            i = stx - buf;
+        }
+        else
+        {
+            size_t n = span_length( &(buf[i]), len - i, IMPL_LIMIT );
+            if( n > 0 )
+            {
+                err = decode_span( td, &(buf[i]), n );
+                i += n;
+                continue;
+            }
+        }
+        err = IMPL(decode_char)( td, buf[i] );
+        i++;
+    }
+    return err;
+}
+
+
+static tic_error_t IMPL(input_bytewise)( tic_decoder_t* td, const tic_char_t *buf, size_t len )
+{
+    tic_error_t err = TIC_OK;
+    uint32_t i;
+    for( i=0; ( err==TIC_OK && i<len ) ; i++ )
+    {
+        err = IMPL(decode_char)( td, buf[i] );
+    }
+    return err;
+}
+
+
+static const tic_decoder_ops_t IMPL(ops) = {
+    .input = IMPL(input),
+    .input_bytewise = IMPL(input_bytewise),
+};
+
+#undef IMPL
+#undef IMPL_SEP
+#undef IMPL_SEP_IN_CHECKSUM
+#undef IMPL_LIMIT
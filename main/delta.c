@@ -0,0 +1,111 @@
+#include <string.h>
+
+#include "tic_log.h"
+
+#include "tic_types.h"
+#include "dataset.h"
+#include "delta.h"
+
+static const char *TAG = "delta.c";
+
+
+void delta_init( delta_state_t *dt, uint32_t keyframe_period_s )
+{
+    memset( dt, 0, sizeof(*dt) );
+    dt->keyframe_period_us = (int64_t)keyframe_period_s * 1000000;
+    dt->force_keyframe = true;
+}
+
+
+void delta_force_keyframe( delta_state_t *dt )
+{
+    dt->force_keyframe = true;
+}
+
+
+// FNV-1a de l'horodate puis de la valeur, séparées pour que "AB"+"C" et "A"+"BC" diffèrent
+static uint32_t signature( const tic_frame_t *frame, const dataset_t *ds )
+{
+    uint32_t h = 2166136261UL;
+    const tic_char_t *txt = dataset_horodate( frame, ds );
+    for( size_t i = 0; i < ds->horodate.len; i++ )
+    {
+        h = ( h ^ (uint8_t)txt[i] ) * 16777619UL;
+    }
+    h = ( h ^ 0xFF ) * 16777619UL;
+    txt = dataset_valeur( frame, ds );
+    for( size_t i = 0; i < ds->valeur.len; i++ )
+    {
+        h = ( h ^ (uint8_t)txt[i] ) * 16777619UL;
+    }
+    return h;
+}
+
+
+bool delta_filter( delta_state_t *dt, tic_frame_t *frame, int64_t now_us )
+{
+    bool keyframe = dt->force_keyframe || ( now_us - dt->keyframe_us >= dt->keyframe_period_us );
+    dt->keyframe_en_attente = keyframe;
+    dt->keyframe_en_attente_us = now_us;
+    memset( dt->en_attente, 0, sizeof(dt->en_attente) );
+    if( keyframe )
+    {
+        dt->keyframes++;
+        ESP_LOGD( TAG, "trame complète" );
+    }
+    else
+    {
+        dt->deltas++;
+    }
+    frame->delta = !keyframe;
+
+    for( const dataset_t *ds = dataset_first( frame ); ds != NULL; ds = dataset_next( frame, ds ) )
+    {
+        // les etiquettes inconnues n'ont pas d'emplacement fixe : toujours publiées
+        if( (ds->flags & TIC_DS_PUBLISHED) == 0 || ds->label >= TIC_LABEL_COUNT )
+        {
+            continue;
+        }
+        uint32_t sig = signature( frame, ds );
+        uint32_t bit = 1UL << (ds->label % 32);
+        bool inchangee = ( dt->connues[ds->label / 32] & bit ) && dt->signatures[ds->label] == sig;
+        dt->signatures_en_attente[ds->label] = sig;
+        dt->en_attente[ds->label / 32] |= bit;
+        if( keyframe )
+        {
+            continue;
+        }
+        if( inchangee )
+        {
+            // la trame est rendue au pool après publication, le flag peut être modifié
+            ((dataset_t *)ds)->flags &= ~TIC_DS_PUBLISHED;
+            dt->labels_skipped++;
+        }
+        else
+        {
+            dt->labels_sent++;
+        }
+    }
+    return keyframe;
+}
+
+
+void delta_commit( delta_state_t *dt )
+{
+    if( dt->keyframe_en_attente )
+    {
+        dt->force_keyframe = false;
+        dt->keyframe_us = dt->keyframe_en_attente_us;
+        dt->keyframe_en_attente = false;
+    }
+    for( uint32_t label = 0; label < TIC_LABEL_COUNT; label++ )
+    {
+        uint32_t bit = 1UL << (label % 32);
+        if( dt->en_attente[label / 32] & bit )
+        {
+            dt->signatures[label] = dt->signatures_en_attente[label];
+            dt->connues[label / 32] |= bit;
+        }
+    }
+    memset( dt->en_attente, 0, sizeof(dt->en_attente) );
+}
@@ -0,0 +1,49 @@
+#include <string.h>
+
+#include "tic_log.h"
+
+#include "energie.h"
+
+static const char *TAG = "energie.c";
+
+
+void east_ring_init( east_ring_t *ring )
+{
+    memset( ring, 0, sizeof(*ring) );
+}
+
+
+void east_ring_add( east_ring_t *ring, const east_point_t *pt )
+{
+    // -1 pour stocker les points dans l'ordre inversé
+    int8_t pos = ( ring->current + TIC_LAST_POINTS_CNT - 1 ) % TIC_LAST_POINTS_CNT;
+    ring->points[pos] = *pt;
+    ring->current = pos;
+}
+
+
+const east_point_t * east_ring_get( const east_ring_t *ring, int8_t i )
+{
+    return &(ring->points[( i + ring->current ) % TIC_LAST_POINTS_CNT]);
+}
+
+
+int32_t east_puissance( const east_point_t *recent, const east_point_t *ancien )
+{
+    if( ancien->east==0 || ancien->us==0 || recent->east==0 || recent->us==0 )
+    {
+        return -1;
+    }
+
+    // le point recent est le plus grand en index et en temps
+    int32_t energie = recent->east - ancien->east;
+    int64_t duree = recent->us - ancien->us;
+    if( duree <= 0 )
+    {
+        ESP_LOGD( TAG, "puissance indisponible : deux index reçus au même instant" );
+        return -1;
+    }
+
+    // energie est en Watt.heure, duree en µs
+    return (int32_t)( ( (int64_t)energie * 3600 * 1000000 ) / duree );
+}
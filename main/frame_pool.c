@@ -0,0 +1,96 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+
+#include "tic_types.h"
+#include "tic_config.h"
+#include "dataset.h"
+#include "frame_pool.h"
+
+static const char *TAG = "frame_pool.c";
+
+// pointeurs vers les trames disponibles
+static QueueHandle_t s_free_frames = NULL;
+
+// bloc unique contenant toutes les trames du pool
+static tic_frame_t *s_frames = NULL;
+
+static frame_pool_stats_t s_stats = {0};
+static portMUX_TYPE s_stats_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+
+tic_error_t frame_pool_init()
+{
+    assert( s_frames == NULL );    // already initialized ?
+
+    s_frames = calloc( TIC_FRAME_POOL_SIZE, sizeof(tic_frame_t) );
+    s_free_frames = xQueueCreate( TIC_FRAME_POOL_SIZE, sizeof(tic_frame_t *) );
+    if( s_frames == NULL || s_free_frames == NULL )
+    {
+        ESP_LOGE( TAG, "frame_pool_init() failed (out of memory ?)" );
+        return TIC_ERR_APP_INIT;
+    }
+
+    for( int i=0; i<TIC_FRAME_POOL_SIZE; i++ )
+    {
+        tic_frame_t *frame = &(s_frames[i]);
+        xQueueSend( s_free_frames, &frame, 0 );
+    }
+    s_stats.pool_size = TIC_FRAME_POOL_SIZE;
+    ESP_LOGI( TAG, "%d trames de %d bytes préallouées", TIC_FRAME_POOL_SIZE, sizeof(tic_frame_t) );
+    return TIC_OK;
+}
+
+
+tic_frame_t * frame_alloc()
+{
+    tic_frame_t *frame = NULL;
+    if( s_free_frames == NULL || xQueueReceive( s_free_frames, &frame, 0 ) != pdTRUE )
+    {
+        taskENTER_CRITICAL( &s_stats_spinlock );
+        s_stats.alloc_failures++;
+        taskEXIT_CRITICAL( &s_stats_spinlock );
+        return NULL;
+    }
+
+    frame_clear( frame );
+
+    taskENTER_CRITICAL( &s_stats_spinlock );
+    s_stats.in_use++;
+    if( s_stats.in_use > s_stats.max_in_use )
+    {
+        s_stats.max_in_use = s_stats.in_use;
+    }
+    taskEXIT_CRITICAL( &s_stats_spinlock );
+    return frame;
+}
+
+
+void frame_free( tic_frame_t *frame )
+{
+    if( frame == NULL )
+    {
+        return;
+    }
+    assert( frame >= s_frames && frame < s_frames + TIC_FRAME_POOL_SIZE );
+
+    if( xQueueSend( s_free_frames, &frame, 0 ) != pdTRUE )
+    {
+        ESP_LOGE( TAG, "frame_free(%p) : trame libérée deux fois ?", frame );
+        return;
+    }
+
+    taskENTER_CRITICAL( &s_stats_spinlock );
+    s_stats.in_use--;
+    taskEXIT_CRITICAL( &s_stats_spinlock );
+}
+
+
+void frame_pool_get_stats( frame_pool_stats_t *stats )
+{
+    assert( stats );
+    taskENTER_CRITICAL( &s_stats_spinlock );
+    memcpy( stats, &s_stats, sizeof(*stats) );
+    taskEXIT_CRITICAL( &s_stats_spinlock );
+}
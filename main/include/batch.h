@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdbool.h>
+#include "tic_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// regroupement de plusieurs trames dans un seul message MQTT
+//
+// le document de chaque trame ( JSON de process.c ou CBOR de cbor_write_frame() ) est copié
+// à la suite des précédents. batch_finish() écrit le message complet :
+//   JSON  {"frames":[ trame, trame, ... ] }
+//         avec les agrégats : {"frames":[ ... ],"agg":{"PAPP":[min,max,dernière], ... } }
+//   CBOR  map { TIC_CBOR_FRAMES : [ trame, ... ], TIC_CBOR_AGG : { identifiant : [min,max,dernière] } }
+// les agrégats portent sur les etiquettes entières de toutes les trames du lot, y compris
+// celles que delta.h n'a pas publiées
+//
+// la place du message complet ( enveloppe et agrégats ) est vérifiée à chaque trame ajoutée :
+// le lot tient toujours dans un payload de MQTT_PAYLOAD_BUFFER_SIZE bytes
+
+#define BATCH_JSON      0
+#define BATCH_CBOR      1
+
+// raison de la publication d'un lot
+typedef enum {
+    BATCH_FLUSH_NONE = 0,   // le lot peut attendre
+    BATCH_FLUSH_SIZE,       // la trame suivante ne tient plus dans le message
+    BATCH_FLUSH_COUNT,      // nombre maximum de trames atteint
+    BATCH_FLUSH_AGE,        // 1re trame du lot trop ancienne, ou plus de trames reçues
+    BATCH_FLUSH_URGENT,     // trame à publier sans attendre
+    BATCH_FLUSH_CAUSES
+} batch_flush_t;
+
+typedef struct {
+    uint32_t messages;                      // lots publiés
+    uint32_t frames;                        // trames publiées dans les lots
+    uint32_t flushes[BATCH_FLUSH_CAUSES];   // lots publiés pour chaque raison
+} batch_stats_t;
+
+typedef struct {
+    int32_t min;
+    int32_t max;
+    int32_t last;
+} batch_agg_t;
+
+typedef struct {
+    uint8_t format;                         // BATCH_JSON ou BATCH_CBOR
+    bool aggregates;
+    uint32_t max_frames;
+    int64_t max_age_us;
+    uint8_t docs[MQTT_PAYLOAD_BUFFER_SIZE]; // documents des trames, séparés par des virgules en JSON
+    size_t len;
+    uint32_t nb_frames;
+    int64_t first_us;                       // 1re trame du lot
+    uint32_t agg_present[TIC_FRAME_PRESENT_WORDS];
+    batch_agg_t agg[TIC_LABEL_COUNT];
+    batch_stats_t stats;
+} batch_t;
+
+void batch_init( batch_t *b, uint8_t format, uint32_t max_frames, uint32_t max_age_s, bool aggregates );
+
+bool batch_is_empty( const batch_t *b );
+
+// ajoute le document doc de la trame frame, reçue à now_us ( µs, esp_timer )
+// TIC_ERR_OVERFLOW si le message complet ne tiendrait plus dans un payload : le lot n'est pas
+// modifié, il faut le publier puis recommencer ( ou abandonner la trame si le lot était vide )
+tic_error_t batch_add( batch_t *b, const void *doc, size_t len, const tic_frame_t *frame, int64_t now_us );
+
+// raison de publier le lot maintenant, urgent si la dernière trame ne doit pas attendre
+batch_flush_t batch_due( const batch_t *b, int64_t now_us, bool urgent );
+
+// écrit le message du lot dans buf ( \0 final en JSON, non compté dans len ) et vide le lot
+tic_error_t batch_finish( batch_t *b, char *buf, size_t size, size_t *len, batch_flush_t cause );
+
+#ifdef __cplusplus
+}       // extern "C"
+#endif
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdbool.h>
+#include "tic_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ecriture d'une trame en CBOR ( RFC 8949 ) en un seul passage, même contenu que le JSON
+// de json_writer.h, plus compact : clés entières, entiers natifs et horodates en temps unix
+//
+// document : map de clés entières
+//   TIC_CBOR_ESP_TIME   tag 1 + temps unix de l'ESP ( secondes )
+//   TIC_CBOR_FREE_MEM   mémoire libre ( bytes )
+//   TIC_CBOR_DROPPED    seulement si la trame est incomplète : tableau des etiquettes écartées
+//                       ( identifiant wire, ou "?" si illisible )
+//   TIC_CBOR_DELTA      seulement pour une trame delta ( delta.h ) : true
+//   TIC_CBOR_TIC        map des etiquettes publiées
+//                       clé = identifiant wire de tic_labels.h ( texte de l'etiquette si inconnue ),
+//                       une seule fois : les doublons d'une etiquette ne sont pas publiés
+//                       valeur = entier ou texte, [horodate, valeur] si l'etiquette a une horodate
+//                       horodate = temps unix, ou le texte reçu s'il n'a pas pu être converti
+//
+// les identifiants wire sont figés dans tic_labels.h : ajouter une etiquette ne change pas les autres clés
+#define TIC_CBOR_ESP_TIME    0
+#define TIC_CBOR_FREE_MEM    1
+#define TIC_CBOR_DROPPED     2
+#define TIC_CBOR_TIC         3
+#define TIC_CBOR_DELTA       4
+#define TIC_CBOR_FRAMES      5      // lot de trames, voir batch.h
+#define TIC_CBOR_AGG         6
+
+// types majeurs CBOR
+#define CBOR_UINT            0
+#define CBOR_NEGINT          1
+#define CBOR_BYTES           2
+#define CBOR_TEXT            3
+#define CBOR_ARRAY           4
+#define CBOR_MAP             5
+#define CBOR_TAG             6
+#define CBOR_SIMPLE          7
+
+#define CBOR_TAG_EPOCH       1
+#define CBOR_TRUE            21     // valeur simple
+
+// même principe que json_writer_t : débordement vérifié avant chaque écriture,
+// cbor_finish() renvoie TIC_ERR_OVERFLOW si le buffer était trop petit
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+    size_t pos;             // bytes écrits
+    bool overflow;
+} cbor_writer_t;
+
+void cbor_init( cbor_writer_t *cw, uint8_t *buf, size_t size );
+
+// entête d'un élément : type majeur et argument ( valeur, longueur ou nombre d'éléments )
+void cbor_head( cbor_writer_t *cw, uint8_t major, uint64_t arg );
+
+void cbor_int( cbor_writer_t *cw, int64_t val );
+void cbor_text( cbor_writer_t *cw, const char *txt, size_t len );
+
+// éléments déjà encodés, copiés tels quels
+void cbor_raw( cbor_writer_t *cw, const uint8_t *data, size_t len );
+
+// taille encodée d'un entête ou d'un entier, pour calculer la place nécessaire avant d'écrire
+size_t cbor_head_size( uint64_t arg );
+size_t cbor_int_size( int64_t val );
+
+// len = nombre de bytes produits, pas de \0 final
+tic_error_t cbor_finish( cbor_writer_t *cw, size_t *len );
+
+// document complet d'une trame
+void cbor_write_frame( cbor_writer_t *cw, const tic_frame_t *frame, int64_t esp_time, uint32_t esp_free_mem );
+
+#ifdef __cplusplus
+}       // extern "C"
+#endif
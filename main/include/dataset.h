@@ -10,29 +10,39 @@
  * Utilisation des datasets par d'autres tâches
  */
 
-dataset_t * dataset_alloc();
+// libere tous les datasets de la trame
+void frame_clear( tic_frame_t *frame );
 
-void dataset_free( dataset_t *dataset );
+// copie un dataset dans l'emplacement de son etiquette, horodate peut être NULL
+// renvoie NULL si la trame est pleine. Le dataset doit ensuite être inséré avec dataset_insert()
+dataset_t * dataset_new( tic_frame_t *frame, tic_label_id_t label,
+                         const tic_char_t *etiquette, size_t etiquette_len,
+                         const tic_char_t *horodate, size_t horodate_len,
+                         const tic_char_t *valeur, size_t valeur_len );
 
-tic_error_t dataset_print( const dataset_t *dataset );
+// marque ds comme présent dans la trame, en temps constant
+void dataset_insert( tic_frame_t *frame, dataset_t *ds );
 
-uint32_t dataset_count( dataset_t *dataset );
+// nombre de datasets présents, en temps constant
+uint8_t dataset_count( const tic_frame_t *frame );
 
-// recherche un element selon son etiquette
-const dataset_t* dataset_find( const dataset_t *ds, const char *etiquette );
-const dataset_t* dataset_find_deux( const dataset_t *ds, const char *label1, const char* label2 );
+// parcours dans l'ordre des etiquettes puis des inconnus, NULL en fin de trame
+const dataset_t * dataset_first( const tic_frame_t *frame );
+const dataset_t * dataset_next( const tic_frame_t *frame, const dataset_t *ds );
 
-// tri selon les étiquettes
-dataset_t * dataset_sort( dataset_t *ds);
+// accès au texte des datasets, chaines terminées par \0
+const tic_char_t * dataset_etiquette( const tic_frame_t *frame, const dataset_t *ds );
+const tic_char_t * dataset_horodate( const tic_frame_t *frame, const dataset_t *ds );    // "" si absente
+const tic_char_t * dataset_valeur( const tic_frame_t *frame, const dataset_t *ds );
 
-// insere ds dans sorted avec tri selon les etiquettes
-dataset_t * dataset_insert( dataset_t *sorted, dataset_t *ds);
+tic_error_t dataset_print( const tic_frame_t *frame );
 
-// ajoute ds après le dernier elements de append_to
-dataset_t * dataset_append( dataset_t *append_to, dataset_t*ds );
+// recherche un element selon l'identifiant de son etiquette, en temps constant
+const dataset_t* dataset_find( const tic_frame_t *frame, tic_label_id_t label );
+const dataset_t* dataset_find_deux( const tic_frame_t *frame, tic_label_id_t label1, tic_label_id_t label2 );
 
-// trouve les flags associés à une donnée
-tic_error_t dataset_flags_definition (const tic_char_t *etiquette, tic_mode_t mode, tic_dataset_flags_t *out_flags);
+// convertit une horodate linky SAAMMJJhhmmss en temps unix
+tic_error_t horodate_to_time_t( const char *horodate, time_t *unix_time );
 
 // extrait les données utilisées pour des traitements
-tic_error_t dataset_parse ( const dataset_t *ds, tic_data_t *data );
+tic_error_t dataset_parse ( const tic_frame_t *frame, tic_data_t *data );
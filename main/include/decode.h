@@ -1,10 +1,35 @@
-
 #pragma once
 
 #include "tic_types.h"
+#include "decoder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// compteurs du stream buffer entre uart_task et decode_task
+typedef struct {
+    uint32_t bytes_received;     // bytes transmis par uart_task
+    uint32_t bytes_dropped;      // bytes perdus car le stream buffer était plein
+    uint32_t overruns;           // nombre d'envois incomplets
+    size_t buffer_max_used;      // remplissage maximum observé
+    size_t buffer_size;          // taille du stream buffer
+    uint32_t lines_dropped;      // lignes écartées par le mode récupération du decodeur
+} decode_stats_t;
 
 // reception des bytes depuis uart_task 
-tic_error_t decode_incoming_bytes (tic_char_t *buf , size_t len, tic_mode_t mode);
+tic_error_t decode_incoming_bytes (const tic_char_t *buf , size_t len, tic_mode_t mode);
+
+// callbacks appelés par tic_decode_task à chaque ligne validée, sans attendre la fin de la trame
+// à appeler avant tic_decode_task_start()
+tic_error_t decode_set_handler( const tic_decoder_handler_t *handler );
+
+// copie les compteurs du stream buffer
+void decode_get_stats( decode_stats_t *stats );
 
 // creation initiale de la tache 
 tic_error_t tic_decode_task_start( );
+
+#ifdef __cplusplus
+}       // extern "C" 
+#endif
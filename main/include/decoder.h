@@ -0,0 +1,137 @@
+#pragma once
+
+// Decodeur TIC portable : machine à états, checksum et remplissage des trames
+// Ne dépend ni de FreeRTOS ni d'ESP-IDF, voir decode.c pour la tâche qui l'utilise sur l'ESP32
+// et host/ pour le benchmark sur PC
+
+#include <stdbool.h>
+#include "tic_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// source des trames vides et destination des trames complètes
+typedef struct {
+    tic_frame_t * (*frame_alloc)( void *ctx );                   // trame vide, NULL si aucune disponible
+    tic_error_t (*frame_ready)( tic_frame_t *frame, void *ctx ); // TIC_OK si la trame a été prise en charge
+    void *ctx;
+} tic_decoder_io_t;
+
+
+// ligne validée par son checksum
+// les chaines sont terminées par \0 et restent dans les buffers du decodeur :
+// elles ne sont valables que pendant l'appel du callback
+typedef struct {
+    tic_label_id_t label;                   // TIC_LABEL_INCONNU si absente de tic_labels.h
+    tic_dataset_flags_t flags;
+    const tic_char_t *etiquette;
+    size_t etiquette_len;
+    const tic_char_t *horodate;             // NULL si pas d'horodate
+    size_t horodate_len;
+    const tic_char_t *valeur;
+    size_t valeur_len;
+} tic_line_t;
+
+// callbacks appelés au fil de la réception, dans la tâche qui appelle decoder_input()
+// tous optionnels. Une trame abandonnée sur erreur n'a pas de frame_end
+typedef struct {
+    void (*frame_start)( tic_mode_t mode, int64_t stx_us, void *ctx );     // STX, voir decoder_set_clock()
+    void (*line)( const tic_line_t *line, void *ctx );     // CR, sauf etiquettes IGNORE
+    void (*frame_end)( void *ctx );                        // ETX, avant frame_ready()
+    void *ctx;
+} tic_decoder_handler_t;
+
+
+// nombre max d'elements dans un dataset : etiquette, horodate, valeur, checksum
+#define TIC_NB_FIELDS 4
+
+// etat du decodeur, à allouer par l'appelant et initialiser avec decoder_init()
+typedef struct tic_decoder_s {
+    
+    // mode historique ou standard
+    tic_mode_t mode;
+    tic_char_t sep;
+    const struct tic_decoder_ops_s *ops;    // fonctions du decodeur spécialisé pour ce mode
+
+    tic_decoder_io_t io;
+    tic_decoder_handler_t handler;
+    tic_frame_t *frame;          // trame en cours de reception, obtenue par io.frame_alloc()
+
+    uint8_t stx_received;  // caractere start of frame recu ?
+
+
+    // buffers pour le dataset en cours de reception
+    tic_char_t buf0[TIC_SIZE_ETIQUETTE];   // etiquette
+    tic_char_t buf1[TIC_SIZE_VALUE];       // horodate ou valeur
+    tic_char_t buf2[TIC_SIZE_VALUE];       // valeur ou checksum reçu
+    tic_char_t buf3[TIC_SIZE_CHECKSUM];    // checksum reçu ou NULL
+
+    // selecteur du buffer courant et curseur d'écriture
+    tic_char_t *cur_buf;
+    size_t cur_buf_size;
+    size_t cur_pos;
+
+    // index du champ courant et longueur des champs terminés
+    uint8_t field;
+    size_t len[TIC_NB_FIELDS];
+
+    // checksum calculé au fil de la réception
+    uint32_t sum;               // somme des caractères reçus depuis LF, séparateurs compris
+    uint32_t sum_before_sep;    // valeur de sum juste avant le dernier séparateur
+
+    // etiquette identifiée au 1er séparateur
+    tic_label_id_t label;
+    tic_dataset_flags_t flags;
+
+    // dataset IGNORE : seul le checksum est calculé, les champs ne sont pas copiés
+    uint8_t skip;
+    tic_char_t last_ch;         // dernier caractère reçu = checksum reçu en fin de dataset
+
+    // mode récupération : une ligne invalide est écartée, la trame continue au LF suivant
+    uint8_t salvage;
+    uint8_t drop_line;          // ligne en cours écartée, attente du prochain LF
+    uint32_t lines_dropped;     // total des lignes écartées
+
+    // heure de réception de STX, fournie par l'appelant
+    int64_t (*stx_clock)( void *ctx );
+    void *stx_clock_ctx;
+    int64_t stx_us;             // STX de la trame en cours, 0 si inconnue
+} tic_decoder_t;
+
+
+
+// prepare le decodeur, mode inconnu jusqu'à decoder_set_mode()
+// io NULL : pas d'assemblage des trames, seulement les callbacks de decoder_set_handler()
+void decoder_init( tic_decoder_t *td, const tic_decoder_io_t *io );
+
+// abonne un consommateur aux lignes au fil de la réception, NULL pour le désabonner
+void decoder_set_handler( tic_decoder_t *td, const tic_decoder_handler_t *handler );
+
+// abandonne la trame en cours et attend le prochain STX
+void decoder_reset( tic_decoder_t *td );
+
+// change le mode ( et le séparateur ), la trame en cours est abandonnée si le mode change
+tic_error_t decoder_set_mode( tic_decoder_t *td, tic_mode_t mode );
+
+// mode récupération : une ligne au checksum faux ( ou trop longue ) est écartée au lieu de
+// faire échouer decoder_input(), et la trame est transmise avec tic_frame_t.nb_rejets > 0
+// un STX reçu avant ETX abandonne la trame en cours et commence la suivante
+void decoder_set_salvage( tic_decoder_t *td, bool enable );
+
+// stx_clock() est appelé à chaque STX decodé et donne l'heure de sa réception en µs ( esp_timer ),
+// 0 si inconnue. Elle est copiée dans tic_frame_t.stx_us et transmise à handler.frame_start()
+// NULL : pas d'horodatage des trames
+void decoder_set_clock( tic_decoder_t *td, int64_t (*stx_clock)( void *ctx ), void *ctx );
+
+// decode les bytes reçus, s'arrête à la 1re erreur
+// l'appelant doit alors appeler decoder_reset()
+// les caractères entre deux delimiteurs sont copiés et sommés par mots ( SWAR )
+tic_error_t decoder_input( tic_decoder_t *td, const tic_char_t *buf, size_t len );
+
+// même resultat que decoder_input(), un caractère à la fois : référence pour le benchmark de host/
+tic_error_t decoder_input_bytewise( tic_decoder_t *td, const tic_char_t *buf, size_t len );
+
+#ifdef __cplusplus
+}       // extern "C" 
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdbool.h>
+#include "tic_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// publication des seules etiquettes modifiées depuis la trame précédente
+//
+// une signature ( hash de l'horodate et de la valeur ) est gardée pour chaque etiquette publiée.
+// Entre deux trames complètes, delta_filter() retire TIC_DS_PUBLISHED des etiquettes dont la
+// signature n'a pas changé et marque la trame avec tic_frame_t.delta : une etiquette absente
+// d'une trame delta a gardé sa dernière valeur publiée, ou n'a pas été reçue.
+// Une trame complète est publiée toutes les keyframe_period_s secondes, et après
+// delta_force_keyframe() ( reconnexion au broker, message perdu )
+//
+// les signatures calculées par delta_filter() ne remplacent les précédentes qu'après delta_commit(),
+// appelé quand la trame a bien été confiée à mqtt_task : une trame non publiée ne fait pas
+// disparaître ses valeurs des trames delta suivantes
+
+typedef struct {
+    uint32_t connues[TIC_FRAME_PRESENT_WORDS];      // etiquettes dont la signature est valide
+    uint32_t signatures[TIC_LABEL_COUNT];
+    uint32_t en_attente[TIC_FRAME_PRESENT_WORDS];   // signatures de la dernière trame, pas encore validées
+    uint32_t signatures_en_attente[TIC_LABEL_COUNT];
+    bool keyframe_en_attente;
+    int64_t keyframe_en_attente_us;
+    int64_t keyframe_period_us;
+    int64_t keyframe_us;            // dernière trame complète
+    bool force_keyframe;
+    // compteurs
+    uint32_t keyframes;
+    uint32_t deltas;
+    uint32_t labels_sent;           // etiquettes publiées dans les trames delta
+    uint32_t labels_skipped;        // etiquettes inchangées, non publiées
+} delta_state_t;
+
+void delta_init( delta_state_t *dt, uint32_t keyframe_period_s );
+
+// la prochaine trame sera complète
+void delta_force_keyframe( delta_state_t *dt );
+
+// prépare la publication de la trame, now_us en µs ( esp_timer )
+// renvoie true pour une trame complète, false si seules les etiquettes modifiées restent publiées
+bool delta_filter( delta_state_t *dt, tic_frame_t *frame, int64_t now_us );
+
+// la trame préparée par le dernier delta_filter() a été publiée ( ou mise en attente ) :
+// ses signatures servent de référence aux trames suivantes
+void delta_commit( delta_state_t *dt );
+
+#ifdef __cplusplus
+}       // extern "C"
+#endif
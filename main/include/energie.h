@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// derniers index d'energie active reçus ( EAST, BASE ), et puissance active entre deux points
+//
+// le ring buffer n'est pas protégé : puissance.c l'écrit depuis tic_decode_task et le lit
+// depuis process_task sous son propre spinlock
+
+#define TIC_LAST_POINTS_CNT  10
+
+typedef struct point_east_s {
+    int64_t us;     // réception de STX de la trame du point, en µs ( esp_timer )
+    int32_t east;                       // index d'energie active soutiree totale du compteur
+} east_point_t;
+
+typedef struct {
+    east_point_t points[TIC_LAST_POINTS_CNT];
+    int8_t current;                     // emplacement du point le plus récent
+} east_ring_t;
+
+void east_ring_init( east_ring_t *ring );
+
+// ajoute un nouveau point, qui devient le point 0
+void east_ring_add( east_ring_t *ring, const east_point_t *pt );
+
+// i=0 : le plus récent, i=TIC_LAST_POINTS_CNT-1 : le plus ancien
+const east_point_t * east_ring_get( const east_ring_t *ring, int8_t i );
+
+// puissance active en W entre le point recent et un point plus ancien, -1 si indisponible
+int32_t east_puissance( const east_point_t *recent, const east_point_t *ancien );
+
+#ifdef __cplusplus
+}       // extern "C"
+#endif
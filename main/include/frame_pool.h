@@ -0,0 +1,29 @@
+#pragma once
+
+#include "tic_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t pool_size;          // nombre de trames préallouées
+    uint32_t in_use;             // trames actuellement allouées
+    uint32_t max_in_use;         // maximum observé
+    uint32_t alloc_failures;     // trames perdues car le pool était vide
+} frame_pool_stats_t;
+
+// alloue toutes les trames du pool en une seule fois
+tic_error_t frame_pool_init();
+
+// prend une trame vide dans le pool, NULL si le pool est vide ( non bloquant )
+tic_frame_t * frame_alloc();
+
+// remet la trame dans le pool
+void frame_free( tic_frame_t *frame );
+
+void frame_pool_get_stats( frame_pool_stats_t *stats );
+
+#ifdef __cplusplus
+}       // extern "C" 
+#endif
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdbool.h>
+#include "tic_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ecriture d'un document JSON en un seul passage dans un buffer fourni par l'appelant
+//
+// la place restante est vérifiée avant chaque écriture : en cas de débordement rien
+// n'est écrit au delà du buffer, les écritures suivantes sont ignorées et
+// json_finish() renvoie TIC_ERR_OVERFLOW
+typedef struct {
+    char *buf;
+    size_t size;            // taille du buffer, \0 final compris
+    size_t pos;             // bytes écrits
+    bool overflow;
+} json_writer_t;
+
+void json_init( json_writer_t *jw, char *buf, size_t size );
+
+// texte copié tel quel ( ponctuation, espaces )
+void json_raw( json_writer_t *jw, const char *txt, size_t len );
+
+// chaine entre guillemets, avec echappement de " \ et des caractères de contrôle
+void json_string( json_writer_t *jw, const char *txt, size_t len );
+
+// entier en décimal, sans snprintf
+void json_int( json_writer_t *jw, int32_t val );
+void json_uint( json_writer_t *jw, uint32_t val );
+
+// termine le document par \0, len = nombre de bytes produits sans le \0 final
+tic_error_t json_finish( json_writer_t *jw, size_t *len );
+
+// ecrit l'objet "tic" d'une trame : etiquettes publiées, "delta" pour une trame delta ( delta.h ),
+// et si la trame est incomplète "incomplete" et la liste "dropped" des etiquettes écartées par le decodeur
+void json_write_frame( json_writer_t *jw, const tic_frame_t *frame );
+
+
+// modèle de l'objet "tic" : texte fixe ( etiquettes, ponctuation ) construit à la 1re trame
+// d'un ensemble d'etiquettes, les trames suivantes n'y insèrent que les valeurs
+// reconstruit quand les etiquettes publiées ( ou leurs horodates ) changent : pour la zone des
+// inconnus, où un même emplacement peut recevoir une autre etiquette, le texte des etiquettes compte
+#define JSON_TEMPLATE_SIZE     2048
+#define JSON_TEMPLATE_SLOTS    (2 * TIC_FRAME_MAX_DATASETS)     // horodate et valeur
+
+typedef struct {
+    uint16_t off;           // position de la valeur dans le texte fixe
+    uint8_t dataset;        // index dans tic_frame_t.datasets
+    bool horodate;          // horodate ou valeur du dataset
+} json_slot_t;
+
+typedef struct {
+    bool valid;
+    uint32_t publies[TIC_FRAME_PRESENT_WORDS];      // datasets publiés lors de la construction
+    uint32_t horodates[TIC_FRAME_PRESENT_WORDS];    // datasets publiés avec horodate
+    char inconnus[TIC_FRAME_MAX_INCONNUS][TIC_SIZE_ETIQUETTE];     // etiquettes publiées de la zone des inconnus
+    char skel[JSON_TEMPLATE_SIZE];
+    size_t skel_len;
+    json_slot_t slots[JSON_TEMPLATE_SLOTS];
+    size_t nb_slots;
+    uint32_t hits;          // trames écrites avec le modèle existant
+    uint32_t rebuilds;      // constructions du modèle
+} json_template_t;
+
+void json_template_init( json_template_t *tpl );
+
+// même texte que json_write_frame(), en réutilisant le modèle si les etiquettes n'ont pas changé
+void json_write_frame_template( json_writer_t *jw, json_template_t *tpl, const tic_frame_t *frame );
+
+#define JSON_RAW( jw, litteral )   json_raw( (jw), (litteral), sizeof(litteral) - 1 )
+
+#ifdef __cplusplus
+}       // extern "C"
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "tic_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// identifiant d'une etiquette en temps constant ( hash parfait généré dans tic_labels_hash.h )
+tic_label_id_t label_lookup( const tic_char_t *etiquette, size_t len );
+
+// texte de l'etiquette, "" si id est invalide
+const tic_char_t * label_name( tic_label_id_t id );
+
+// clé CBOR figée de l'etiquette ( colonne wire de tic_labels.h ), TIC_LABEL_WIRE_INCONNU si id est invalide
+#define TIC_LABEL_WIRE_INCONNU   0xFFFF
+uint16_t label_wire( tic_label_id_t id );
+
+// etiquette d'une clé CBOR, TIC_LABEL_INCONNU si elle n'existe pas ( recherche linéaire, pour les récepteurs )
+tic_label_id_t label_from_wire( uint32_t wire );
+
+// flags de publication d'une etiquette dans le mode donné
+// TIC_ERR_UNKNOWN_DATA si l'etiquette n'existe pas dans ce mode
+tic_error_t label_flags( tic_label_id_t id, tic_mode_t mode, tic_dataset_flags_t *out_flags );
+
+// type de la valeur d'une etiquette, TIC_TYPE_TEXTE si id est invalide
+tic_type_t label_type( tic_label_id_t id );
+
+// convertit la valeur selon le type de l'etiquette
+// TIC_ERR_BAD_DATA si la valeur ne correspond pas au type
+tic_error_t label_parse_value( tic_label_id_t id, const tic_char_t *valeur, size_t len, tic_value_t *out );
+
+#ifdef __cplusplus
+}       // extern "C" 
+#endif
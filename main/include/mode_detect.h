@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdbool.h>
+#include "tic_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// detection du mode TIC à partir des premiers bytes reçus
+//
+// chaque ligne LF ... CR est vérifiée avec les deux règles de checksum :
+//  - standard   : separateur TAB avant le checksum, compris dans la somme
+//  - historique : separateur SPACE avant le checksum, exclu de la somme
+// le mode est verrouillé dès MODE_DETECT_MIN_LINES lignes valides,
+// un flux de bytes hors TIC ou de lignes invalides signale un mauvais baudrate
+
+#define MODE_DETECT_MIN_LINES      2       // lignes valides pour verrouiller le mode
+#define MODE_DETECT_MIN_BYTES      32      // bytes reçus avant de conclure à un mauvais baudrate
+#define MODE_DETECT_MAX_BAD_LINES  3       // lignes invalides sans aucune ligne valide
+#define MODE_DETECT_MAX_UART_ERR   3       // erreurs parité/frame UART sans aucune ligne valide
+#define MODE_DETECT_LINE_MAX       128     // au delà ce n'est pas une ligne TIC
+
+typedef enum {
+    MODE_DETECT_EN_COURS = 0,           // pas encore assez de données
+    MODE_DETECT_VERROUILLE,             // mode trouvé, voir mode_detect_t.mode
+    MODE_DETECT_MAUVAIS_BAUDRATE,       // données incohérentes au baudrate actuel
+} mode_detect_result_t;
+
+typedef struct {
+    tic_mode_t mode;                // mode verrouillé, TIC_MODE_INCONNU avant
+    uint32_t bytes;                 // bytes analysés
+    uint32_t invalid_bytes;         // bytes impossibles en TIC
+    uint16_t uart_errors;           // erreurs signalées par mode_detect_uart_error()
+    uint16_t lines_standard;        // lignes valides en mode standard
+    uint16_t lines_historique;      // lignes valides en mode historique
+    uint16_t lines_bad;             // lignes au checksum faux dans les deux modes
+    uint16_t frames_ok;             // trames STX ... ETX dont toutes les lignes sont valides
+    // ligne en cours
+    bool synced;                    // 1er LF ou STX reçu
+    bool in_line;
+    bool in_frame;
+    bool frame_bad;
+    uint8_t line_len;
+    uint16_t frame_lines;
+    uint32_t sum;                   // somme des bytes de la ligne
+    tic_char_t last;                // dernier byte : checksum à la fin de la ligne
+    tic_char_t prev;                // avant dernier byte : separateur avant le checksum
+} mode_detect_t;
+
+// remet le detecteur à zéro, à chaque changement de baudrate
+void mode_detect_reset( mode_detect_t *md );
+
+// analyse des bytes reçus, s'arrête de compter au verrouillage
+mode_detect_result_t mode_detect_input( mode_detect_t *md, const tic_char_t *buf, size_t len );
+
+// erreur de parité, de frame ou break signalée par l'UART
+mode_detect_result_t mode_detect_uart_error( mode_detect_t *md );
+
+#ifdef __cplusplus
+}       // extern "C"
+#endif
@@ -1,15 +1,60 @@
+#pragma once
 
+#include "tic_types.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
 
-#include "tic_types.h"
 
+typedef struct {
+    uint32_t pool_size;          // nombre de messages préalloués ( CONFIG_TIC_MQTT_MSG_POOL_SIZE )
+    uint32_t in_use;             // messages actuellement alloués
+    uint32_t max_in_use;         // maximum observé
+    uint32_t alloc_failures;     // trames non publiées car le pool était vide
+} mqtt_msg_pool_stats_t;
+
+// publication QoS1 ( CONFIG_TIC_MQTT_QOS1 ) : messages confiés à l'outbox du client,
+// au plus window en attente de PUBACK
+typedef struct {
+    uint32_t window;             // CONFIG_TIC_MQTT_QOS1_WINDOW
+    uint32_t in_flight;          // messages en attente de PUBACK
+    uint32_t enqueued;           // messages confiés au client
+    uint32_t acked;              // PUBACK reçus
+    uint32_t retransmits_est;    // estimation des PUBLISH réémis d'après le délai du PUBACK, pas un compte
+    uint32_t expired;            // messages sans PUBACK, abandonnés
+    uint32_t rejected;           // refusés par esp_mqtt_client_enqueue()
+    uint32_t window_full;        // messages non publiés car la fenêtre était pleine
+    uint32_t ack_ms_last;        // délai entre l'enqueue et le PUBACK
+    uint32_t ack_ms_max;
+} mqtt_qos1_stats_t;
+
+// alias de topic MQTT 5 ( CONFIG_TIC_MQTT5_TOPIC_ALIAS_MAX ), publication QoS0 seulement
+typedef struct {
+    uint32_t alias_max;          // CONFIG_TIC_MQTT5_TOPIC_ALIAS_MAX
+    uint32_t aliases;            // topics ayant un alias
+    uint32_t registrations;      // PUBLISH avec le topic complet et l'alias
+    uint32_t hits;               // PUBLISH avec l'alias seul
+    uint32_t topic_bytes_saved;  // bytes de topic non envoyés
+} mqtt_alias_stats_t;
+
+// alloue tous les messages du pool en une seule fois
+tic_error_t mqtt_msg_pool_init();
 
-// Alloue un message mqtt
+// prend un message vide dans le pool, NULL si le pool est vide ( non bloquant )
 mqtt_msg_t * mqtt_msg_alloc();
 
-// libere un message mqtt
+// remet le message dans le pool
 void mqtt_msg_free(mqtt_msg_t *msg);
 
+void mqtt_msg_pool_get_stats( mqtt_msg_pool_stats_t *stats );
+
+// compteurs à 0 sans CONFIG_TIC_MQTT_QOS1
+void mqtt_qos1_get_stats( mqtt_qos1_stats_t *stats );
+
+// compteurs à 0 sans alias de topic
+void mqtt_alias_get_stats( mqtt_alias_stats_t *stats );
+
 // place un message MQTT dans la queue d'envoi du client mqtt
 tic_error_t mqtt_receive_msg( mqtt_msg_t *msg);
 
@@ -19,4 +64,6 @@ tic_error_t mqtt_client_restart();
 // Initialise le client MQTT et lance la tache associee
 tic_error_t mqtt_task_start(int dummy);
 
-
+#ifdef __cplusplus
+}       // extern "C" 
+#endif
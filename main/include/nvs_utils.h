@@ -14,6 +14,13 @@ tic_error_t console_nvs_get_blob( const char* key, char **out_buf, size_t *out_l
 // alloue un buffer qui doit être libéré par l'appelant 
 tic_error_t console_nvs_get_blob_as_string( const char* key, char **out_buf );
 
+// TIC_ERR_NVS si la clé est absente, out inchangé
+tic_error_t console_nvs_get_u8( const char* key, uint8_t *out );
+
+// blob de taille connue, sans allocation. TIC_ERR_NVS si la clé est absente ou de taille différente
+tic_error_t console_nvs_get_blob_fixed( const char* key, void *out, size_t len );
+tic_error_t console_nvs_set_blob( const char* key, const void *data, size_t len );
+
 //set/print value in any namespace
 esp_err_t set_value_in_nvs(const char *namespace, const char *key, const char *str_type, const char *str_value);
 esp_err_t print_value_from_nvs(const char *namespace, const char *key, const char *str_type);
@@ -1,7 +1,42 @@
+#pragma once
+
 
 #include "tic_types.h"
+#include "batch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// mesure de la serialisation des trames, JSON en cycles CPU
+typedef struct {
+    uint32_t json_frames;           // trames serialisées
+    uint32_t json_cycles_last;
+    uint32_t json_cycles_max;
+    uint64_t json_cycles_total;     // moyenne = total / frames
+    size_t json_bytes_last;         // taille du dernier payload
+    uint32_t json_template_hits;    // trames écrites avec le modèle JSON existant
+    uint32_t json_template_rebuilds; // constructions du modèle ( etiquettes publiées changées )
+    uint32_t cbor_frames;           // trames publiées en CBOR
+    size_t cbor_bytes_last;
+    uint32_t delta_keyframes;       // trames publiées complètes ( CONFIG_TIC_PUBLISH_DELTA )
+    uint32_t delta_frames;          // trames publiées avec les seules etiquettes modifiées
+    uint32_t delta_labels_sent;
+    uint32_t delta_labels_skipped;  // etiquettes inchangées non publiées
+    batch_stats_t batch_json;       // lots de trames ( CONFIG_TIC_BATCH )
+    batch_stats_t batch_cbor;
+} process_stats_t;
+
+tic_error_t process_receive_frame( tic_frame_t *frame );
+
+void process_get_stats( process_stats_t *stats );
 
+// la prochaine trame publiée sera complète ( connexion au broker ), sans effet sans CONFIG_TIC_PUBLISH_DELTA
+void process_force_keyframe( void );
 
-tic_error_t process_receive_datasets( dataset_t *ds );
+tic_error_t process_task_start( );
 
-tic_error_t process_task_start( );
\ No newline at end of file
+#ifdef __cplusplus
+}       // extern "C" 
+#endif
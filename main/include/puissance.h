@@ -1,12 +1,14 @@
 
 #include "tic_types.h"
 
-void puissance_init();
-
-tic_error_t puissance_incoming_data( const tic_data_t *data );
+// s'abonne aux lignes EAST et BASE du decodeur, avant tic_decode_task_start()
+// les points sont datés par l'heure de réception de STX de leur trame
+tic_error_t puissance_init();
 
+// puissance active en W entre le dernier index reçu et le n-ième précédent, -1 si indisponible
 int32_t puissance_get( uint8_t n );
 
-dataset_t * puissance_get_all();
+// ajoute les puissances actives à la trame
+void puissance_get_all( tic_frame_t *frame );
 
 //void puissance_debug();
\ No newline at end of file
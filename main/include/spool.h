@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdbool.h>
+#include "tic_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// messages MQTT mis de côté en flash quand le broker est injoignable
+//
+// la partition TIC_SPOOL_PARTITION est un anneau d'enregistrements ( entête, topic, payload )
+// écrits à la suite, sans chevaucher deux secteurs. Un secteur est effacé quand l'écriture y
+// entre : s'il contient encore des messages non relus, les plus anciens sont perdus.
+// La position de lecture est sauvegardée en NVS par spool_commit(), celle d'écriture est
+// retrouvée au démarrage en relisant les enregistrements qui suivent.
+// Utilisé par une seule tâche ( mqtt_publish_task ), seuls les compteurs sont protégés
+
+typedef struct {
+    uint32_t size;              // taille de la partition
+    uint32_t pending;           // messages en attente
+    uint32_t appended;          // messages écrits
+    uint32_t replayed;          // messages relus
+    uint32_t dropped;           // messages écrasés avant d'être relus
+    uint32_t errors;            // erreurs flash et enregistrements illisibles
+} spool_stats_t;
+
+// ouvre la partition et retrouve les messages en attente
+tic_error_t spool_init();
+
+bool spool_is_empty();
+
+// ajoute un message à la fin du spool
+tic_error_t spool_append( const mqtt_msg_t *msg );
+
+// copie le plus ancien message dans msg ( buffers de MQTT_TOPIC_BUFFER_SIZE et MQTT_PAYLOAD_BUFFER_SIZE )
+// sans le retirer du spool. TIC_ERR si le spool est vide
+tic_error_t spool_peek( mqtt_msg_t *msg );
+
+// retire le message lu par spool_peek()
+void spool_consume();
+
+// sauvegarde la position de lecture en NVS, à appeler après chaque série de messages relus
+void spool_commit();
+
+void spool_get_stats( spool_stats_t *stats );
+
+#ifdef __cplusplus
+}       // extern "C"
+#endif
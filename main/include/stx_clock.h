@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdbool.h>
+#include "tic_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// heure de réception des STX, de uart_rcv_task vers tic_decode_task
+//
+// chaque heure est repérée par la position de son STX dans le flux du stream buffer ( bytes
+// réellement transmis, comptés par les deux tâches ). Avant chaque bloc donné au decodeur,
+// stx_clock_chunk() associe une heure à chaque STX du bloc, puis stx_clock_next() les rend
+// dans l'ordre aux appels du decodeur. Les heures non utilisées sont oubliées à la fin du bloc :
+// les heures perdues et la fin d'un bloc abandonnée par le decodeur ne décalent pas les suivantes
+
+typedef struct {
+    uint32_t pos;               // position du STX dans le flux
+    int64_t us;                 // heure de réception ( esp_timer )
+} stx_time_t;
+
+// STX datés dans un bloc, les suivants ont une heure inconnue
+#define STX_CHUNK_MAX   16
+
+// heure transmise suivante, false si aucune
+typedef bool (*stx_source_t)( stx_time_t *t, void *ctx );
+
+typedef struct {
+    uint32_t pos;                   // position du prochain bloc dans le flux
+    bool pending;                   // next déjà lue, pour un STX d'un bloc suivant
+    stx_time_t next;
+    int64_t us[STX_CHUNK_MAX];      // heures des STX du bloc, 0 si inconnue
+    size_t nb;
+    size_t used;                    // heures déjà rendues au decodeur
+} stx_clock_t;
+
+void stx_clock_init( stx_clock_t *c );
+
+// avant decoder_input() : heures des STX du bloc, lues dans source, et avance de len bytes dans le flux
+// à appeler pour chaque bloc reçu, même s'il n'est pas decodé
+void stx_clock_chunk( stx_clock_t *c, const tic_char_t *buf, size_t len, stx_source_t source, void *ctx );
+
+// pour decoder_set_clock(), ctx = stx_clock_t : heure du STX suivant du bloc, 0 si inconnue
+int64_t stx_clock_next( void *ctx );
+
+#ifdef __cplusplus
+}       // extern "C"
+#endif
@@ -3,6 +3,15 @@
 
 // ************** MQTT *****************************
 #define MQTT_TOPIC_FORMAT "home/elec/%s"
+// suffixe du topic des payloads CBOR, publiés en parallèle du JSON
+#define MQTT_TOPIC_CBOR_SUFFIX "/cbor"
+// suffixe du topic des lots de trames ( batch.h ), après MQTT_TOPIC_CBOR_SUFFIX pour le CBOR
+#define MQTT_TOPIC_BATCH_SUFFIX "/batch"
+
+// ******************* Trames ************************
+// nombre de trames préallouées : une en cours de decodage, une en cours de traitement,
+// les autres en attente dans la queue de process_task
+#define TIC_FRAME_POOL_SIZE  8
 
 // ******************* Process ***********************
 // délai max entre deux trames correctes
@@ -15,11 +24,17 @@
 #define TIC_NVS_MQTT_BROKER   "mqtt_uri"
 #define TIC_NVS_MQTT_PSK_ID   "mqtt_psk_id"
 #define TIC_NVS_MQTT_PSK_KEY  "mqtt_psk_key"
+#define TIC_NVS_PAYLOAD_FORMAT "payload_fmt"  // u8 : 0 JSON, 1 CBOR, 2 JSON et CBOR ( sinon Kconfig )
+#define TIC_NVS_SPOOL_POS     "spool_pos"     // blob : position de lecture du spool
 
 
 // **************** UART *****************
 // nombre de bytes à recevoir avant de lancer le traitement
 #define TIC_UART_THRESOLD  64
 
+// ****************** Spool **************
+// partition data des messages non publiés, voir partitions_custom.csv
+#define TIC_SPOOL_PARTITION   "spool"
+
 // ****************** WIFI **************
 #define WIFI_RECONNECT_LOOP_DELAY   10000      // ms
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+
+// Table des etiquettes TIC connues, triée par ordre alphabétique ( strcmp )
+// l'ordre des identifiants est donc l'ordre de tri des etiquettes
+//
+// X( identifiant, etiquette, wire, mode, type, flags )
+//   wire  : clé de l'etiquette dans les payloads CBOR ( cbor_writer.h ), figée : une etiquette
+//           garde son numéro, une nouvelle etiquette prend le suivant jamais utilisé, le numéro
+//           d'une etiquette retirée n'est pas réutilisé
+//   mode INCONNU : etiquette valable dans tous les modes
+//   type  : conversion de la valeur par le decodeur ( voir tic_type_t )
+//           TEXTE, ENTIER ( décimal ), ENUM ( valeurs de TIC_ENUM_VALUES ),
+//           BITS ( hexadécimal ), HORODATE ( pas de valeur, seulement l'horodate )
+//   flags : PUBLIE, PUBLIE_TS ( publiée avec son horodate ) ou IGNORE ( pas copiée dans la trame )
+//
+// Après toute modification, regénérer tic_labels_hash.h avec tools/gen_labels_hash.py
+#define TIC_LABELS(X) \
+    X( ADCO,      "ADCO",      0,  HISTORIQUE, TEXTE,    PUBLIE    )  /* numero de serie du compteur */ \
+    X( ADSC,      "ADSC",      1,  STANDARD,   TEXTE,    PUBLIE    )  /* numero de serie du compteur */ \
+    X( BASE,      "BASE",      2,  HISTORIQUE, ENTIER,   PUBLIE    )  /* index d'energie en tarif de base */ \
+    X( CCASN,     "CCASN",     3,  STANDARD,   ENTIER,   PUBLIE_TS )  /* courbe de charge de la periode N (pas 30 minutes) */ \
+    X( CCASN_1,   "CCASN-1",   4,  STANDARD,   ENTIER,   PUBLIE_TS )  /* courbe de charge de la période N-1 (pas 30 minutes) */ \
+    X( DATE,      "DATE",      5,  STANDARD,   HORODATE, PUBLIE_TS )  /* heure et date courante (sans données) */ \
+    X( EASD01,    "EASD01",    6,  STANDARD,   ENTIER,   IGNORE    )  /* index distributeur */ \
+    X( EASD02,    "EASD02",    7,  STANDARD,   ENTIER,   IGNORE    ) \
+    X( EASD03,    "EASD03",    8,  STANDARD,   ENTIER,   IGNORE    ) \
+    X( EASD04,    "EASD04",    9,  STANDARD,   ENTIER,   IGNORE    ) \
+    X( EASF01,    "EASF01",    10, STANDARD,   ENTIER,   IGNORE    )  /* index fournisseur */ \
+    X( EASF02,    "EASF02",    11, STANDARD,   ENTIER,   IGNORE    ) \
+    X( EASF03,    "EASF03",    12, STANDARD,   ENTIER,   IGNORE    ) \
+    X( EASF04,    "EASF04",    13, STANDARD,   ENTIER,   IGNORE    ) \
+    X( EASF05,    "EASF05",    14, STANDARD,   ENTIER,   IGNORE    ) \
+    X( EASF06,    "EASF06",    15, STANDARD,   ENTIER,   IGNORE    ) \
+    X( EASF07,    "EASF07",    16, STANDARD,   ENTIER,   IGNORE    ) \
+    X( EASF08,    "EASF08",    17, STANDARD,   ENTIER,   IGNORE    ) \
+    X( EASF09,    "EASF09",    18, STANDARD,   ENTIER,   IGNORE    ) \
+    X( EASF10,    "EASF10",    19, STANDARD,   ENTIER,   IGNORE    ) \
+    X( EAST,      "EAST",      20, STANDARD,   ENTIER,   PUBLIE    )  /* energie active soutirée */ \
+    X( HCHC,      "HCHC",      21, HISTORIQUE, ENTIER,   PUBLIE    )  /* index d'energie heures creuses */ \
+    X( HCHP,      "HCHP",      22, HISTORIQUE, ENTIER,   PUBLIE    )  /* index d'energie heures pleines */ \
+    X( IINST,     "IINST",     23, HISTORIQUE, ENTIER,   PUBLIE    )  /* intensite instantanée */ \
+    X( IMAX,      "IMAX",      24, HISTORIQUE, ENTIER,   IGNORE    )  /* intensité max */ \
+    X( IRMS1,     "IRMS1",     25, STANDARD,   ENTIER,   PUBLIE    )  /* intensite instantanée */ \
+    X( ISOUSC,    "ISOUSC",    26, HISTORIQUE, ENTIER,   IGNORE    )  /* intensite souscrite */ \
+    X( LTARF,     "LTARF",     27, STANDARD,   TEXTE,    IGNORE    )  /* libellé tarif fournisseur en cours */ \
+    X( MOTDETAT,  "MOTDETAT",  28, HISTORIQUE, BITS,     IGNORE    )  /* mot d'etat du compteur */ \
+    X( MSG1,      "MSG1",      29, STANDARD,   TEXTE,    IGNORE    )  /* message court */ \
+    X( MSG2,      "MSG2",      30, STANDARD,   TEXTE,    IGNORE    )  /* message ultra-court */ \
+    X( NGTF,      "NGTF",      31, STANDARD,   TEXTE,    IGNORE    )  /* nom calendrier fournisseur */ \
+    X( NJOURF,    "NJOURF",    32, STANDARD,   ENTIER,   IGNORE    )  /* numero jour en cours calendrier fournisseur */ \
+    X( NJOURF_P1, "NJOURF+1",  33, STANDARD,   ENTIER,   IGNORE    )  /* numero prochain jour calendrier fournisseur */ \
+    X( NTARF,     "NTARF",     34, STANDARD,   ENTIER,   IGNORE    )  /* numero index tarifaire en cours */ \
+    X( OPTARIF,   "OPTARIF",   35, HISTORIQUE, ENUM,     IGNORE    )  /* option tarifaire */ \
+    X( PACT01,    "PACT01",    36, INCONNU,    ENTIER,   PUBLIE    )  /* puissances actives calculées par puissance.c */ \
+    X( PACT02,    "PACT02",    37, INCONNU,    ENTIER,   PUBLIE    ) \
+    X( PACT03,    "PACT03",    38, INCONNU,    ENTIER,   PUBLIE    ) \
+    X( PACT04,    "PACT04",    39, INCONNU,    ENTIER,   PUBLIE    ) \
+    X( PACT05,    "PACT05",    40, INCONNU,    ENTIER,   PUBLIE    ) \
+    X( PACT06,    "PACT06",    41, INCONNU,    ENTIER,   PUBLIE    ) \
+    X( PACT07,    "PACT07",    42, INCONNU,    ENTIER,   PUBLIE    ) \
+    X( PACT08,    "PACT08",    43, INCONNU,    ENTIER,   PUBLIE    ) \
+    X( PACT09,    "PACT09",    44, INCONNU,    ENTIER,   PUBLIE    ) \
+    X( PAPP,      "PAPP",      45, HISTORIQUE, ENTIER,   PUBLIE    )  /* puissance apparente instantanée */ \
+    X( PCOUP,     "PCOUP",     46, STANDARD,   ENTIER,   IGNORE    )  /* puissance coupure */ \
+    X( PJOURF_P1, "PJOURF+1",  47, STANDARD,   TEXTE,    IGNORE    )  /* profil prochain jour calendrier fournisseur */ \
+    X( PREF,      "PREF",      48, STANDARD,   ENTIER,   IGNORE    )  /* puissance apparente de référence */ \
+    X( PRM,       "PRM",       49, STANDARD,   TEXTE,    IGNORE    )  /* numéro PRM ou PDL ( référence enedis ) */ \
+    X( PTEC,      "PTEC",      50, HISTORIQUE, ENUM,     IGNORE    )  /* periode tarifaire en cours */ \
+    X( RELAIS,    "RELAIS",    51, STANDARD,   ENTIER,   IGNORE    )  /* etat des relais */ \
+    X( SINSTS,    "SINSTS",    52, STANDARD,   ENTIER,   PUBLIE    )  /* puissance apparente instantanée */ \
+    X( SMAXSN,    "SMAXSN",    53, STANDARD,   ENTIER,   PUBLIE_TS )  /* puissance apparente maxi du jour en cours */ \
+    X( SMAXSN_1,  "SMAXSN-1",  54, STANDARD,   ENTIER,   PUBLIE_TS )  /* puissance apparente maxi de la veille */ \
+    X( STGE,      "STGE",      55, STANDARD,   BITS,     IGNORE    )  /* flags d'état */ \
+    X( UMOY1,     "UMOY1",     56, STANDARD,   ENTIER,   PUBLIE_TS )  /* tension moyenne ( pas 10 minutes ) */ \
+    X( URMS1,     "URMS1",     57, STANDARD,   ENTIER,   PUBLIE    )  /* tension instantanée */ \
+    X( VTIC,      "VTIC",      58, STANDARD,   ENTIER,   IGNORE    )  /* version de la TIC */
+
+
+// valeurs des etiquettes de type ENUM, l'index d'une valeur est son rang pour l'etiquette
+// E( identifiant, début de la valeur )
+#define TIC_ENUM_VALUES(E) \
+    E( OPTARIF,   "BASE" )  /* option base */ \
+    E( OPTARIF,   "HC.." )  /* option heures creuses */ \
+    E( OPTARIF,   "EJP." )  /* option EJP */ \
+    E( OPTARIF,   "BBR" )   /* option tempo, 4e caractère = programme */ \
+    E( PTEC,      "TH.." )  /* toutes les heures */ \
+    E( PTEC,      "HC.." )  /* heures creuses */ \
+    E( PTEC,      "HP.." )  /* heures pleines */ \
+    E( PTEC,      "HN.." )  /* heures normales */ \
+    E( PTEC,      "PM.." )  /* heures de pointe mobile */ \
+    E( PTEC,      "HCJB" )  /* tempo : heures creuses jours bleus */ \
+    E( PTEC,      "HCJW" ) \
+    E( PTEC,      "HCJR" ) \
+    E( PTEC,      "HPJB" ) \
+    E( PTEC,      "HPJW" ) \
+    E( PTEC,      "HPJR" )
+
+
+#define TIC_LABEL_ENUM(id, name, wire, mode, type, flags)  TIC_LABEL_##id,
+
+typedef enum {
+    TIC_LABELS(TIC_LABEL_ENUM)
+    TIC_LABEL_COUNT,
+    TIC_LABEL_INCONNU = 0xFF     // etiquette absente de la table
+} tic_label_id_t;
+
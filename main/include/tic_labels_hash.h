@@ -0,0 +1,78 @@
+// Fichier généré par tools/gen_labels_hash.py - ne pas modifier
+#pragma once
+
+#include <stdint.h>
+#include "tic_labels.h"
+
+#define TIC_LABEL_HASH_SEED  0x141
+#define TIC_LABEL_HASH_MULT  31
+#define TIC_LABEL_HASH_BITS  8
+#define TIC_LABEL_HASH_SIZE  (1 << TIC_LABEL_HASH_BITS)
+
+// 59 etiquettes
+static const uint8_t TIC_LABEL_HASH_TABLE[TIC_LABEL_HASH_SIZE] = {
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_SMAXSN,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_EASD01, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_IRMS1,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_STGE, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_LTARF, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_EASD03, TIC_LABEL_EASD02, TIC_LABEL_INCONNU, TIC_LABEL_EASD04,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_RELAIS, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_PREF, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_PRM, TIC_LABEL_HCHC, TIC_LABEL_NTARF,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_MOTDETAT, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_BASE, TIC_LABEL_INCONNU, TIC_LABEL_ADCO, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_PJOURF_P1, TIC_LABEL_OPTARIF,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_EAST, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_URMS1, TIC_LABEL_INCONNU,
+    TIC_LABEL_NGTF, TIC_LABEL_MSG2, TIC_LABEL_MSG1, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_IINST, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_EASF09, TIC_LABEL_EASF08, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_CCASN_1, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_EASF01, TIC_LABEL_ISOUSC, TIC_LABEL_EASF03, TIC_LABEL_EASF02,
+    TIC_LABEL_EASF05, TIC_LABEL_EASF04, TIC_LABEL_EASF07, TIC_LABEL_EASF06,
+    TIC_LABEL_SINSTS, TIC_LABEL_INCONNU, TIC_LABEL_PAPP, TIC_LABEL_INCONNU,
+    TIC_LABEL_DATE, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_PTEC, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_ADSC, TIC_LABEL_INCONNU,
+    TIC_LABEL_PACT04, TIC_LABEL_PACT03, TIC_LABEL_PACT02, TIC_LABEL_PACT01,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_CCASN, TIC_LABEL_HCHP, TIC_LABEL_VTIC, TIC_LABEL_PACT09,
+    TIC_LABEL_PACT08, TIC_LABEL_PACT07, TIC_LABEL_PACT06, TIC_LABEL_PACT05,
+    TIC_LABEL_INCONNU, TIC_LABEL_IMAX, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_NJOURF, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_UMOY1,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_EASF10, TIC_LABEL_NJOURF_P1,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_SMAXSN_1,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+    TIC_LABEL_PCOUP, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU, TIC_LABEL_INCONNU,
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+// journalisation des modules portables ( decoder.c, dataset.c, labels.c )
+// esp_log sur l'ESP32, stderr sur l'hôte pour le benchmark de host/
+
+#ifdef ESP_PLATFORM
+
+#include "esp_log.h"
+
+#else
+
+#include <stdio.h>
+#include <inttypes.h>
+
+// 0 = rien, 1 = erreurs, 2 = + warnings, 3 = + info, 4 = + debug
+#ifndef TIC_HOST_LOG_LEVEL
+#define TIC_HOST_LOG_LEVEL 2
+#endif
+
+#define TIC_HOST_LOG( level, letter, tag, format, ... ) \
+    do { \
+        if( (level) <= TIC_HOST_LOG_LEVEL ) \
+            fprintf( stderr, letter " (%s) " format "\n", tag, ##__VA_ARGS__ ); \
+    } while( 0 )
+
+#define ESP_LOGE( tag, format, ... )  TIC_HOST_LOG( 1, "E", tag, format, ##__VA_ARGS__ )
+#define ESP_LOGW( tag, format, ... )  TIC_HOST_LOG( 2, "W", tag, format, ##__VA_ARGS__ )
+#define ESP_LOGI( tag, format, ... )  TIC_HOST_LOG( 3, "I", tag, format, ##__VA_ARGS__ )
+#define ESP_LOGD( tag, format, ... )  TIC_HOST_LOG( 4, "D", tag, format, ##__VA_ARGS__ )
+#define ESP_LOGV( tag, format, ... )  TIC_HOST_LOG( 5, "V", tag, format, ##__VA_ARGS__ )
+
+#endif
@@ -1,6 +1,13 @@
 #pragma once
 
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+#ifdef ESP_PLATFORM
 #include "esp_event.h"         // pour ESP_EVENT_DECLARE_BASE()
+#endif
+#include "tic_labels.h"        // pour tic_label_id_t
 
 
 // ***************** Modes TIC ******************
@@ -12,7 +19,9 @@ typedef enum {
 
 
 // ***************** Status ******************
+#ifdef ESP_PLATFORM
 ESP_EVENT_DECLARE_BASE(STATUS_EVENTS);         // declaration of the task events family
+#endif
 enum {
     STATUS_EVENT_NONE = 0,
     STATUS_EVENT_BAUDRATE,
@@ -27,7 +36,7 @@ enum {
 //**************** datasets ****************
 
 typedef char tic_char_t;
-typedef uint32_t tic_dataset_flags_t;
+typedef uint8_t tic_dataset_flags_t;
 
 
 // taille des buffers
@@ -35,15 +44,26 @@ typedef uint32_t tic_dataset_flags_t;
 #define TIC_SIZE_VALUE        128    // donnée ou horodate
 #define TIC_SIZE_CHECKSUM     4      // checksum
 
-typedef struct flagdef_s {
-    tic_char_t label[TIC_SIZE_ETIQUETTE];
-    tic_dataset_flags_t flags;
-} flags_definition_t;
-
 // TODO remplacer par une enum
 #define TIC_DS_PUBLISHED       (1 << 0)
 #define TIC_DS_HAS_TIMESTAMP   (1 << 1)
-#define TIC_DS_NUMERIQUE       (1 << 2)
+
+
+// type des valeurs, déclaré pour chaque etiquette dans tic_labels.h
+typedef enum {
+    TIC_TYPE_TEXTE = 0,        // chaine, pas de conversion
+    TIC_TYPE_ENTIER,           // nombre décimal -> tic_value_t.entier
+    TIC_TYPE_ENUM,             // valeur listée dans TIC_ENUM_VALUES -> tic_value_t.index
+    TIC_TYPE_BITS,             // champ de bits hexadécimal -> tic_value_t.bits
+    TIC_TYPE_HORODATE,         // pas de valeur, seulement l'horodate
+} tic_type_t;
+
+// valeur convertie par le decodeur selon le type de l'etiquette
+typedef union {
+    int32_t entier;
+    uint32_t bits;
+    uint8_t index;
+} tic_value_t;
 
 
 typedef char id_compteur_t[16];      // 12 caractères d'après la spec enedis
@@ -54,19 +74,62 @@ typedef struct {
     int32_t index_energie;          // 9 car. valeur max 999 999 999 Wh -> int32 ok
     int32_t puissance_app;          // 5 car. valeur max 99 999 VA
     time_t horodate;
+    int64_t stx_us;                 // réception de STX en µs ( esp_timer ), 0 si inconnue
  } tic_data_t;
 
 
-//tic_dataset_t est une liste de données décodées = contenu d'une trame complete
+// morceau de texte stocké dans le buffer d'une trame
+typedef struct {
+    uint16_t off;          // position du 1er caractère dans tic_frame_t.buf
+    uint8_t len;           // longueur sans le \0 final
+} tic_slice_t;
+
+// dataset_t est une donnée décodée. Le texte est stocké dans le buffer de la trame,
+// utiliser les accesseurs de dataset.h pour le lire
 typedef struct dataset_s {
-    tic_char_t etiquette[TIC_SIZE_ETIQUETTE];
-    tic_char_t horodate[TIC_SIZE_VALUE];
-    tic_char_t valeur[TIC_SIZE_VALUE];
+    tic_slice_t etiquette;
+    tic_slice_t horodate;                      // len=0 si pas d'horodate
+    tic_slice_t valeur;
     tic_dataset_flags_t flags;
-    struct dataset_s *next;                    // linked_list
+    uint8_t label;                             // tic_label_id_t, TIC_LABEL_INCONNU si absente de tic_labels.h
+    uint8_t type;                              // tic_type_t, TIC_TYPE_TEXTE si la conversion a échoué
+    tic_value_t val;                           // valeur convertie, sauf pour TIC_TYPE_TEXTE
+    uint32_t ts;                               // horodate convertie en temps unix, 0 si absente
 } dataset_t;
 
 
+// datasets d'etiquette inconnue ( ou en double ) conservés dans une trame
+#define TIC_FRAME_MAX_INCONNUS   8
+
+// lignes écartées par le mode récupération du decodeur, dont l'etiquette est mémorisée
+#define TIC_FRAME_MAX_REJETS     8
+
+// emplacements d'une trame : un par etiquette connue, puis la zone des inconnus
+#define TIC_FRAME_MAX_DATASETS   (TIC_LABEL_COUNT + TIC_FRAME_MAX_INCONNUS)
+#define TIC_FRAME_PRESENT_WORDS  ((TIC_FRAME_MAX_DATASETS + 31) / 32)
+
+// texte de tous les datasets d'une trame ( ~1000 bytes pour une trame standard monophasée )
+#define TIC_FRAME_BUF_SIZE       1280
+
+// trame complete = contenu d'une trame TIC
+// datasets[id] contient l'etiquette id, le parcours dans l'ordre des index donne l'ordre alphabétique
+// suivi des inconnus dans leur ordre d'arrivée.
+// les datasets et leur texte sont stockés dans la trame, qui est libérée en une seule opération
+typedef struct tic_frame_s {
+    tic_mode_t mode;                            // mode du decodeur à la réception de STX
+    int64_t stx_us;                             // réception de STX en µs ( esp_timer ), 0 si inconnue
+    uint8_t nb_datasets;                        // nombre de datasets présents
+    uint8_t nb_inconnus;                        // datasets utilisés dans la zone des inconnus
+    uint16_t buf_used;                          // nombre de bytes utilisés dans buf
+    uint8_t nb_rejets;                          // lignes écartées sur erreur : trame incomplète si > 0
+    uint8_t rejets[TIC_FRAME_MAX_REJETS];       // tic_label_id_t des 1res lignes écartées, TIC_LABEL_INCONNU si illisible
+    uint8_t delta;                              // seules les etiquettes modifiées sont publiées, voir delta.h
+    uint32_t present[TIC_FRAME_PRESENT_WORDS];  // bit i à 1 si datasets[i] est présent
+    dataset_t datasets[TIC_FRAME_MAX_DATASETS];
+    tic_char_t buf[TIC_FRAME_BUF_SIZE];
+} tic_frame_t;
+
+
 //*******************  errors **************
 typedef enum tic_error_enum {
     TIC_OK = 0,
@@ -93,6 +156,9 @@ typedef enum tic_error_enum {
 
 typedef struct mqtt_msg_s {
     char *payload;
+    size_t payload_len;     // bytes du payload, 0 si terminé par \0
+    bool binaire;           // payload CBOR, à ne pas afficher comme du texte
+    bool par_etiquette;     // payload ( etiquette \0 valeur \0 )..., un message retenu par etiquette sur topic/<etiquette>
     char *topic;
 } mqtt_msg_t;
 
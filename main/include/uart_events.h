@@ -1,5 +1,6 @@
 
 
+
 #include "tic_types.h"
 
 
@@ -7,9 +8,23 @@
 extern "C" {
 #endif
 
+// detection du mode TIC par uart_rcv_task
+typedef struct {
+    tic_mode_t mode;             // mode verrouillé, TIC_MODE_INCONNU pendant la detection
+    uint32_t lock_ms;            // durée de la detection jusqu'au verrouillage du mode
+    uint32_t first_frame_ms;     // durée jusqu'à la 1ère trame valide, 0 si pas encore reçue
+    uint32_t detections;         // nb de detections ( demarrage + pertes du mode )
+    uint32_t baud_changes;       // nb de changements de baudrate
+    uint32_t frame_wakeups;      // trames lues en une fois sur ETX ( CONFIG_TIC_UART_FRAME_WAKEUP )
+    uint32_t data_wakeups;       // evènements UART_DATA reçus par uart_rcv_task
+} uart_detect_stats_t;
+
 tic_error_t uart_task_start( );
 int uart_get_rx_baudrate();
 
+// copie les compteurs de la detection du mode
+void uart_get_detect_stats( uart_detect_stats_t *stats );
+
 #ifdef __cplusplus
 }       // extern "C" 
 #endif
@@ -0,0 +1,364 @@
+#include <string.h>
+
+#include "tic_log.h"
+
+#include "tic_types.h"
+#include "dataset.h"
+#include "labels.h"
+#include "json_writer.h"
+
+static const char *TAG = "json_writer.c";
+
+
+void json_init( json_writer_t *jw, char *buf, size_t size )
+{
+    jw->buf = buf;
+    jw->size = size;
+    jw->pos = 0;
+    jw->overflow = ( size == 0 );
+}
+
+
+// réserve len bytes, en gardant la place du \0 final
+static char * reserve( json_writer_t *jw, size_t len )
+{
+    if( jw->overflow || len > jw->size - 1 - jw->pos )
+    {
+        jw->overflow = true;
+        return NULL;
+    }
+    char *p = &(jw->buf[jw->pos]);
+    jw->pos += len;
+    return p;
+}
+
+
+void json_raw( json_writer_t *jw, const char *txt, size_t len )
+{
+    char *p = reserve( jw, len );
+    if( p )
+    {
+        memcpy( p, txt, len );
+    }
+}
+
+
+static inline bool needs_escape( char ch )
+{
+    return ch == '"' || ch == '\\' || (uint8_t)ch < 0x20;
+}
+
+
+void json_string( json_writer_t *jw, const char *txt, size_t len )
+{
+    static const char HEX[] = "0123456789abcdef";
+
+    JSON_RAW( jw, "\"" );
+    size_t start = 0;
+    for( size_t i = 0; i < len; i++ )
+    {
+        char ch = txt[i];
+        if( !needs_escape( ch ) )
+        {
+            continue;
+        }
+        // copie d'un bloc de tout ce qui précède le caractère à echapper
+        json_raw( jw, &(txt[start]), i - start );
+        start = i + 1;
+        if( ch == '"' || ch == '\\' )
+        {
+            char esc[2] = { '\\', ch };
+            json_raw( jw, esc, 2 );
+        }
+        else
+        {
+            char esc[6] = { '\\', 'u', '0', '0', HEX[(ch >> 4) & 0x0F], HEX[ch & 0x0F] };
+            json_raw( jw, esc, 6 );
+        }
+    }
+    json_raw( jw, &(txt[start]), len - start );
+    JSON_RAW( jw, "\"" );
+}
+
+
+void json_uint( json_writer_t *jw, uint32_t val )
+{
+    // chiffres écrits de droite à gauche, 10 au plus pour un uint32_t
+    char digits[10];
+    size_t n = sizeof(digits);
+    do
+    {
+        digits[--n] = '0' + ( val % 10 );
+        val /= 10;
+    } while( val != 0 );
+    json_raw( jw, &(digits[n]), sizeof(digits) - n );
+}
+
+
+void json_int( json_writer_t *jw, int32_t val )
+{
+    if( val < 0 )
+    {
+        JSON_RAW( jw, "-" );
+        json_uint( jw, (uint32_t)0 - (uint32_t)val );     // INT32_MIN compris
+        return;
+    }
+    json_uint( jw, (uint32_t)val );
+}
+
+
+tic_error_t json_finish( json_writer_t *jw, size_t *len )
+{
+    if( jw->size > 0 )
+    {
+        jw->buf[jw->pos] = '\0';
+    }
+    if( len )
+    {
+        *len = jw->pos;
+    }
+    if( jw->overflow )
+    {
+        ESP_LOGE( TAG, "JSON buffer overflow (%zu bytes)", jw->size );
+        return TIC_ERR_OVERFLOW;
+    }
+    return TIC_OK;
+}
+
+
+// valeur d'un dataset : entiers convertis par le decodeur, les autres types sont publiés
+// en texte ( BITS reste en hexadécimal )
+static void write_valeur( json_writer_t *jw, const tic_frame_t *frame, const dataset_t *ds )
+{
+    if( ds->type == TIC_TYPE_ENTIER )
+    {
+        json_int( jw, ds->val.entier );
+    }
+    else
+    {
+        json_string( jw, dataset_valeur( frame, ds ), ds->valeur.len );
+    }
+}
+
+
+// trame delta, et trame récupérée par le decodeur : etiquettes des lignes écartées
+static void write_rejets( json_writer_t *jw, const tic_frame_t *frame )
+{
+    if( frame->delta )
+    {
+        JSON_RAW( jw, "\"delta\":true,\n" );
+    }
+    if( frame->nb_rejets == 0 )
+    {
+        return;
+    }
+    JSON_RAW( jw, "\"incomplete\":true,\n\"dropped\":[" );
+    for( size_t i = 0; i < frame->nb_rejets && i < TIC_FRAME_MAX_REJETS; i++ )
+    {
+        if( i > 0 )
+        {
+            JSON_RAW( jw, "," );
+        }
+        const tic_char_t *name = ( frame->rejets[i] == TIC_LABEL_INCONNU ) ? "?" : label_name( frame->rejets[i] );
+        json_string( jw, name, strlen( name ) );
+    }
+    JSON_RAW( jw, "],\n" );
+}
+
+
+// debut d'un dataset : "ETIQUETTE":{
+static void write_cle( json_writer_t *jw, const tic_frame_t *frame, const dataset_t *ds, bool first )
+{
+    // virgule avant chaque donnée sauf la 1ère : pas de virgule finale si les dernières ne sont pas publiées
+    if( !first )
+    {
+        JSON_RAW( jw, ",\n" );
+    }
+    JSON_RAW( jw, "  " );
+    json_string( jw, dataset_etiquette( frame, ds ), ds->etiquette.len );
+    JSON_RAW( jw, ":{" );
+}
+
+
+// objet "tic" : etiquettes publiées
+static void write_datasets( json_writer_t *jw, const tic_frame_t *frame )
+{
+    JSON_RAW( jw, "\"tic\" : {\n" );
+    bool first = true;
+    for( const dataset_t *ds = dataset_first( frame ); ds != NULL; ds = dataset_next( frame, ds ) )
+    {
+        // ignore les etiquettes non exportées
+        if( (ds->flags & TIC_DS_PUBLISHED) == 0 )
+        {
+            continue;
+        }
+        // "ETIQUETTE":{"horodate":"...", "val":...}
+        write_cle( jw, frame, ds, first );
+        first = false;
+        if( ds->flags & TIC_DS_HAS_TIMESTAMP )
+        {
+            JSON_RAW( jw, "\"horodate\":" );
+            json_string( jw, dataset_horodate( frame, ds ), ds->horodate.len );
+            JSON_RAW( jw, ", " );
+        }
+        JSON_RAW( jw, "\"val\":" );
+        write_valeur( jw, frame, ds );
+        JSON_RAW( jw, "}" );
+    }
+    if( !first )
+    {
+        JSON_RAW( jw, "\n" );
+    }
+    JSON_RAW( jw, "}" );
+}
+
+
+void json_write_frame( json_writer_t *jw, const tic_frame_t *frame )
+{
+    write_rejets( jw, frame );
+    write_datasets( jw, frame );
+}
+
+
+// ******************* modèle de trame ******************
+
+void json_template_init( json_template_t *tpl )
+{
+    memset( tpl, 0, sizeof(*tpl) );
+}
+
+
+// datasets publiés, datasets avec horodate et etiquettes de la zone des inconnus :
+// le modèle est valable tant qu'ils ne changent pas
+static void frame_signature( const tic_frame_t *frame, uint32_t *publies, uint32_t *horodates,
+                             char inconnus[TIC_FRAME_MAX_INCONNUS][TIC_SIZE_ETIQUETTE] )
+{
+    memset( publies, 0, TIC_FRAME_PRESENT_WORDS * sizeof(uint32_t) );
+    memset( horodates, 0, TIC_FRAME_PRESENT_WORDS * sizeof(uint32_t) );
+    memset( inconnus, 0, TIC_FRAME_MAX_INCONNUS * TIC_SIZE_ETIQUETTE );
+    for( const dataset_t *ds = dataset_first( frame ); ds != NULL; ds = dataset_next( frame, ds ) )
+    {
+        if( ds->flags & TIC_DS_PUBLISHED )
+        {
+            size_t idx = ds - frame->datasets;
+            publies[idx / 32] |= 1UL << (idx % 32);
+            if( ds->flags & TIC_DS_HAS_TIMESTAMP )
+            {
+                horodates[idx / 32] |= 1UL << (idx % 32);
+            }
+            if( idx >= TIC_LABEL_COUNT )
+            {
+                size_t len = ( ds->etiquette.len < TIC_SIZE_ETIQUETTE ) ? ds->etiquette.len : TIC_SIZE_ETIQUETTE - 1;
+                memcpy( inconnus[idx - TIC_LABEL_COUNT], dataset_etiquette( frame, ds ), len );
+            }
+        }
+    }
+}
+
+
+static void add_slot( json_template_t *tpl, const json_writer_t *skel, const tic_frame_t *frame, const dataset_t *ds, bool horodate )
+{
+    if( tpl->nb_slots >= JSON_TEMPLATE_SLOTS )
+    {
+        tpl->valid = false;
+        return;
+    }
+    json_slot_t *slot = &(tpl->slots[tpl->nb_slots++]);
+    slot->off = skel->pos;
+    slot->dataset = ds - frame->datasets;
+    slot->horodate = horodate;
+}
+
+
+// même texte que json_write_frame(), sans les valeurs dont la position est mémorisée
+static void template_build( json_template_t *tpl, const tic_frame_t *frame )
+{
+    json_writer_t skel;
+    json_init( &skel, tpl->skel, sizeof(tpl->skel) );
+    tpl->valid = true;
+    tpl->nb_slots = 0;
+
+    JSON_RAW( &skel, "\"tic\" : {\n" );
+    bool first = true;
+    for( const dataset_t *ds = dataset_first( frame ); ds != NULL; ds = dataset_next( frame, ds ) )
+    {
+        if( (ds->flags & TIC_DS_PUBLISHED) == 0 )
+        {
+            continue;
+        }
+        write_cle( &skel, frame, ds, first );
+        first = false;
+        if( ds->flags & TIC_DS_HAS_TIMESTAMP )
+        {
+            JSON_RAW( &skel, "\"horodate\":" );
+            add_slot( tpl, &skel, frame, ds, true );
+            JSON_RAW( &skel, ", " );
+        }
+        JSON_RAW( &skel, "\"val\":" );
+        add_slot( tpl, &skel, frame, ds, false );
+        JSON_RAW( &skel, "}" );
+    }
+    if( !first )
+    {
+        JSON_RAW( &skel, "\n" );
+    }
+    JSON_RAW( &skel, "}" );
+
+    size_t len;
+    if( json_finish( &skel, &len ) != TIC_OK )
+    {
+        ESP_LOGW( TAG, "modèle JSON trop grand, trames ecrites sans modèle" );
+        tpl->valid = false;
+    }
+    tpl->skel_len = len;
+    tpl->rebuilds++;
+}
+
+
+void json_write_frame_template( json_writer_t *jw, json_template_t *tpl, const tic_frame_t *frame )
+{
+    write_rejets( jw, frame );
+
+    uint32_t publies[TIC_FRAME_PRESENT_WORDS];
+    uint32_t horodates[TIC_FRAME_PRESENT_WORDS];
+    char inconnus[TIC_FRAME_MAX_INCONNUS][TIC_SIZE_ETIQUETTE];
+    frame_signature( frame, publies, horodates, inconnus );
+    if( tpl->valid && memcmp( publies, tpl->publies, sizeof(publies) ) == 0
+                   && memcmp( horodates, tpl->horodates, sizeof(horodates) ) == 0
+                   && memcmp( inconnus, tpl->inconnus, sizeof(inconnus) ) == 0 )
+    {
+        tpl->hits++;
+    }
+    else
+    {
+        memcpy( tpl->publies, publies, sizeof(publies) );
+        memcpy( tpl->horodates, horodates, sizeof(horodates) );
+        memcpy( tpl->inconnus, inconnus, sizeof(inconnus) );
+        template_build( tpl, frame );
+    }
+    if( !tpl->valid )
+    {
+        // modèle trop grand : écriture complète, reconstruit à chaque trame
+        write_datasets( jw, frame );
+        return;
+    }
+
+    // texte fixe copié par blocs entre les valeurs
+    size_t pos = 0;
+    for( size_t i = 0; i < tpl->nb_slots; i++ )
+    {
+        const json_slot_t *slot = &(tpl->slots[i]);
+        json_raw( jw, &(tpl->skel[pos]), slot->off - pos );
+        pos = slot->off;
+        const dataset_t *ds = &(frame->datasets[slot->dataset]);
+        if( slot->horodate )
+        {
+            json_string( jw, dataset_horodate( frame, ds ), ds->horodate.len );
+        }
+        else
+        {
+            write_valeur( jw, frame, ds );
+        }
+    }
+    json_raw( jw, &(tpl->skel[pos]), tpl->skel_len - pos );
+}
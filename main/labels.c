@@ -0,0 +1,208 @@
+#include <string.h>
+#include <assert.h>
+
+#include "tic_types.h"
+#include "labels.h"
+#include "tic_labels_hash.h"
+
+#define PUBLIE (TIC_DS_PUBLISHED)
+#define PUBLIE_TS (PUBLIE|TIC_DS_HAS_TIMESTAMP)
+#define IGNORE 0
+
+
+typedef struct {
+    const tic_char_t *name;
+    uint16_t wire;                   // clé CBOR
+    tic_mode_t mode;                 // TIC_MODE_INCONNU = tous les modes
+    tic_type_t type;
+    tic_dataset_flags_t flags;
+} label_definition_t;
+
+#define TIC_LABEL_DEFINITION(id, name, wire, mode, type, flags)  { name, wire, TIC_MODE_##mode, TIC_TYPE_##type, flags },
+
+static const label_definition_t TIC_LABEL_DEFINITIONS[TIC_LABEL_COUNT] = {
+    TIC_LABELS(TIC_LABEL_DEFINITION)
+};
+
+
+typedef struct {
+    tic_label_id_t label;
+    const tic_char_t *valeur;
+} enum_definition_t;
+
+#define TIC_ENUM_DEFINITION(id, valeur)  { TIC_LABEL_##id, valeur },
+
+static const enum_definition_t TIC_ENUM_DEFINITIONS[] = {
+    TIC_ENUM_VALUES(TIC_ENUM_DEFINITION)
+};
+
+
+// doit rester identique à label_hash() dans tools/gen_labels_hash.py
+static uint32_t label_hash( const tic_char_t *etiquette, size_t len )
+{
+    uint32_t h = TIC_LABEL_HASH_SEED;
+    for( size_t i=0; i<len; i++ )
+    {
+        h = h * TIC_LABEL_HASH_MULT + (uint8_t)etiquette[i];
+    }
+    return (h ^ (h >> 16)) & (TIC_LABEL_HASH_SIZE - 1);
+}
+
+
+tic_label_id_t label_lookup( const tic_char_t *etiquette, size_t len )
+{
+    tic_label_id_t id = TIC_LABEL_HASH_TABLE[label_hash( etiquette, len )];
+    if( id == TIC_LABEL_INCONNU )
+    {
+        return TIC_LABEL_INCONNU;
+    }
+
+    // une etiquette inconnue peut avoir le même hash qu'une etiquette connue
+    const tic_char_t *name = TIC_LABEL_DEFINITIONS[id].name;
+    if( strncmp( name, etiquette, len ) != 0 || name[len] != '\0' )
+    {
+        return TIC_LABEL_INCONNU;
+    }
+    return id;
+}
+
+
+const tic_char_t * label_name( tic_label_id_t id )
+{
+    return ( id < TIC_LABEL_COUNT ) ? TIC_LABEL_DEFINITIONS[id].name : "";
+}
+
+
+uint16_t label_wire( tic_label_id_t id )
+{
+    return ( id < TIC_LABEL_COUNT ) ? TIC_LABEL_DEFINITIONS[id].wire : TIC_LABEL_WIRE_INCONNU;
+}
+
+
+tic_label_id_t label_from_wire( uint32_t wire )
+{
+    for( tic_label_id_t id = 0; id < TIC_LABEL_COUNT; id++ )
+    {
+        if( TIC_LABEL_DEFINITIONS[id].wire == wire )
+        {
+            return id;
+        }
+    }
+    return TIC_LABEL_INCONNU;
+}
+
+
+tic_error_t label_flags( tic_label_id_t id, tic_mode_t mode, tic_dataset_flags_t *out_flags )
+{
+    assert( out_flags );
+    if( id >= TIC_LABEL_COUNT )
+    {
+        return TIC_ERR_UNKNOWN_DATA;
+    }
+
+    const label_definition_t *def = &(TIC_LABEL_DEFINITIONS[id]);
+    if( (mode != TIC_MODE_INCONNU) && (def->mode != TIC_MODE_INCONNU) && (def->mode != mode) )
+    {
+        return TIC_ERR_UNKNOWN_DATA;
+    }
+    *out_flags = def->flags;
+    return TIC_OK;
+}
+
+
+tic_type_t label_type( tic_label_id_t id )
+{
+    return ( id < TIC_LABEL_COUNT ) ? TIC_LABEL_DEFINITIONS[id].type : TIC_TYPE_TEXTE;
+}
+
+
+static tic_error_t parse_entier( const tic_char_t *valeur, size_t len, int32_t *out )
+{
+    size_t i = 0;
+    int32_t signe = 1;
+    if( len > 0 && valeur[0] == '-' )
+    {
+        signe = -1;
+        i++;
+    }
+
+    // 9 chiffres max : index d'energie en Wh, tient dans un int32
+    if( i == len || len - i > 9 )
+    {
+        return TIC_ERR_BAD_DATA;
+    }
+
+    int32_t n = 0;
+    for( ; i<len; i++ )
+    {
+        if( valeur[i] < '0' || valeur[i] > '9' )
+        {
+            return TIC_ERR_BAD_DATA;
+        }
+        n = n * 10 + (valeur[i] - '0');
+    }
+    *out = signe * n;
+    return TIC_OK;
+}
+
+
+static tic_error_t parse_bits( const tic_char_t *valeur, size_t len, uint32_t *out )
+{
+    if( len == 0 || len > 8 )
+    {
+        return TIC_ERR_BAD_DATA;
+    }
+
+    uint32_t n = 0;
+    for( size_t i=0; i<len; i++ )
+    {
+        tic_char_t c = valeur[i];
+        uint32_t digit;
+        if( c >= '0' && c <= '9' )      { digit = c - '0'; }
+        else if( c >= 'A' && c <= 'F' ) { digit = c - 'A' + 10; }
+        else if( c >= 'a' && c <= 'f' ) { digit = c - 'a' + 10; }
+        else                            { return TIC_ERR_BAD_DATA; }
+        n = (n << 4) | digit;
+    }
+    *out = n;
+    return TIC_OK;
+}
+
+
+static tic_error_t parse_enum( tic_label_id_t id, const tic_char_t *valeur, size_t len, uint8_t *out )
+{
+    uint8_t index = 0;
+    for( size_t i=0; i<sizeof(TIC_ENUM_DEFINITIONS)/sizeof(TIC_ENUM_DEFINITIONS[0]); i++ )
+    {
+        const enum_definition_t *def = &(TIC_ENUM_DEFINITIONS[i]);
+        if( def->label != id )
+        {
+            continue;
+        }
+        size_t def_len = strlen( def->valeur );
+        if( len >= def_len && strncmp( valeur, def->valeur, def_len ) == 0 )
+        {
+            *out = index;
+            return TIC_OK;
+        }
+        index++;
+    }
+    return TIC_ERR_BAD_DATA;
+}
+
+
+tic_error_t label_parse_value( tic_label_id_t id, const tic_char_t *valeur, size_t len, tic_value_t *out )
+{
+    assert( out );
+    switch( label_type( id ) )
+    {
+        case TIC_TYPE_ENTIER:
+            return parse_entier( valeur, len, &(out->entier) );
+        case TIC_TYPE_BITS:
+            return parse_bits( valeur, len, &(out->bits) );
+        case TIC_TYPE_ENUM:
+            return parse_enum( id, valeur, len, &(out->index) );
+        default:
+            return TIC_OK;      // TEXTE et HORODATE : rien à convertir
+    }
+}
@@ -11,6 +11,7 @@
 
 #include "uart_events.h"
 #include "decode.h"
+#include "puissance.h"
 #include "process.h"
 #include "wifi.h"
 #include "mqtt.h"
@@ -97,6 +98,7 @@ void app_main(void)
 #endif
     ticled_task_start();
     uart_task_start();
+    puissance_init();           // avant le decodeur, qui lui transmet les index d'energie
     tic_decode_task_start();
     process_task_start();
     mqtt_task_start( 0 );   // 0=lance le client mqtt   1=dummy/debug
@@ -0,0 +1,214 @@
+#include <string.h>
+#include <inttypes.h>
+
+#include "tic_log.h"
+
+#include "tic_types.h"
+#include "mode_detect.h"
+
+static const char *TAG = "mode_detect.c";
+
+#define CHAR_STX   0x02    //   start of text - début d'une trame
+#define CHAR_ETX   0x03    //   end of text - fin d'une trame
+#define CHAR_EOT   0x04    //   end of transmission - trame interrompue ( mode historique )
+#define CHAR_CR    '\r'
+#define CHAR_LF    '\n'
+#define CHAR_SPACE ' '
+#define CHAR_TAB   '\t'
+
+// proportion de bytes hors TIC tolérée : 1/8
+#define INVALID_BYTES_SHIFT   3
+
+
+void mode_detect_reset( mode_detect_t *md )
+{
+    memset( md, 0, sizeof(mode_detect_t) );
+    md->mode = TIC_MODE_INCONNU;
+}
+
+
+static tic_char_t checksum( uint32_t sum )
+{
+    return (tic_char_t)( (sum & 0x3F) + 0x20 );
+}
+
+
+// fin de ligne : essaie les deux règles de checksum
+static void end_of_line( mode_detect_t *md )
+{
+    md->in_line = false;
+
+    bool standard = false;
+    bool historique = false;
+    if( md->line_len >= 3 )
+    {
+        // sum contient aussi le checksum reçu
+        uint32_t sum = md->sum - (uint8_t)md->last;
+        standard   = ( md->prev == CHAR_TAB )   && ( checksum( sum ) == md->last );
+        historique = ( md->prev == CHAR_SPACE ) && ( checksum( sum - CHAR_SPACE ) == md->last );
+    }
+
+    if( standard )
+    {
+        md->lines_standard++;
+    }
+    else if( historique )
+    {
+        md->lines_historique++;
+    }
+    else
+    {
+        md->lines_bad++;
+        md->frame_bad = true;
+    }
+    md->frame_lines++;
+}
+
+
+static void bad_line( mode_detect_t *md )
+{
+    md->in_line = false;
+    md->lines_bad++;
+    md->frame_bad = true;
+}
+
+
+static mode_detect_result_t verdict( mode_detect_t *md )
+{
+    // le mode n'est verrouillé que si l'autre n'a aucune ligne valide
+    if( md->lines_standard >= MODE_DETECT_MIN_LINES && md->lines_historique == 0
+        && md->lines_standard > md->lines_bad )
+    {
+        md->mode = TIC_MODE_STANDARD;
+    }
+    else if( md->lines_historique >= MODE_DETECT_MIN_LINES && md->lines_standard == 0
+        && md->lines_historique > md->lines_bad )
+    {
+        md->mode = TIC_MODE_HISTORIQUE;
+    }
+    if( md->mode != TIC_MODE_INCONNU )
+    {
+        return MODE_DETECT_VERROUILLE;
+    }
+
+    // aucune ligne valide : trop de bytes hors TIC, de lignes fausses ou d'erreurs UART
+    if( md->lines_standard == 0 && md->lines_historique == 0 )
+    {
+        if( md->bytes >= MODE_DETECT_MIN_BYTES
+            && ( md->invalid_bytes << INVALID_BYTES_SHIFT ) > md->bytes )
+        {
+            ESP_LOGD( TAG, "%" PRIu32 " bytes invalides sur %" PRIu32, md->invalid_bytes, md->bytes );
+            return MODE_DETECT_MAUVAIS_BAUDRATE;
+        }
+        if( md->lines_bad >= MODE_DETECT_MAX_BAD_LINES )
+        {
+            ESP_LOGD( TAG, "%u lignes invalides", md->lines_bad );
+            return MODE_DETECT_MAUVAIS_BAUDRATE;
+        }
+        if( md->uart_errors >= MODE_DETECT_MAX_UART_ERR )
+        {
+            ESP_LOGD( TAG, "%u erreurs UART", md->uart_errors );
+            return MODE_DETECT_MAUVAIS_BAUDRATE;
+        }
+    }
+    return MODE_DETECT_EN_COURS;
+}
+
+
+mode_detect_result_t mode_detect_input( mode_detect_t *md, const tic_char_t *buf, size_t len )
+{
+    for( size_t i = 0; i < len; i++ )
+    {
+        tic_char_t ch = buf[i];
+        md->bytes++;
+
+        switch( ch )
+        {
+            case CHAR_STX:
+                md->synced = true;
+                md->in_frame = true;
+                md->frame_bad = md->in_line;
+                md->frame_lines = 0;
+                md->in_line = false;
+                break;
+
+            case CHAR_ETX:
+            case CHAR_EOT:
+                if( md->in_line )
+                {
+                    bad_line( md );
+                }
+                if( ch == CHAR_ETX && md->in_frame && !md->frame_bad && md->frame_lines > 0 )
+                {
+                    md->frames_ok++;
+                }
+                md->in_frame = false;
+                break;
+
+            case CHAR_LF:
+                if( md->in_line )
+                {
+                    bad_line( md );
+                }
+                md->synced = true;
+                md->in_line = true;
+                md->line_len = 0;
+                md->sum = 0;
+                md->last = 0;
+                md->prev = 0;
+                break;
+
+            case CHAR_CR:
+                if( md->in_line )
+                {
+                    end_of_line( md );
+                }
+                else if( md->synced )
+                {
+                    md->invalid_bytes++;
+                }
+                break;
+
+            default:
+                // hors ASCII imprimable ( et TAB ) : impossible en TIC
+                if( ( ch < CHAR_SPACE || ch > 0x7E ) && ch != CHAR_TAB )
+                {
+                    md->invalid_bytes++;
+                    break;
+                }
+                // hors d'une ligne : impossible aussi, sauf avant le 1er LF ou STX ( fin d'une ligne déjà commencée )
+                if( !md->in_line )
+                {
+                    if( md->synced )
+                    {
+                        md->invalid_bytes++;
+                    }
+                    break;
+                }
+                if( md->line_len >= MODE_DETECT_LINE_MAX )
+                {
+                    bad_line( md );
+                    break;
+                }
+                md->line_len++;
+                md->sum += (uint8_t)ch;
+                md->prev = md->last;
+                md->last = ch;
+                break;
+        }
+    }
+
+    return verdict( md );
+}
+
+
+mode_detect_result_t mode_detect_uart_error( mode_detect_t *md )
+{
+    md->uart_errors++;
+    // la ligne en cours a perdu un byte
+    if( md->in_line )
+    {
+        bad_line( md );
+    }
+    return verdict( md );
+}
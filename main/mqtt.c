@@ -6,9 +6,11 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "freertos/event_groups.h"
 #include "esp_netif.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_tls.h"
 #include "mqtt_client.h"
 
@@ -17,6 +19,8 @@
 #include "event_loop.h"
 #include "mqtt.h"
 #include "nvs_utils.h"
+#include "process.h"     // process_force_keyframe()
+#include "spool.h"
 
 static const char *TAG = "mqtt.c";
 
@@ -28,11 +32,67 @@ EventGroupHandle_t s_client_evt_group = NULL;
 // messages à envoyer
 static QueueHandle_t s_to_mqtt = NULL;
 
+// connexion au broker établie, mis à jour par mqtt_event_handler()
+static volatile bool s_connected = false;
+
+#ifdef CONFIG_TIC_SPOOL
+// false si spool_init() a échoué ( partition absente ou illisible ) : publication sans spool
+static bool s_spool = false;
+#endif
+
+#ifdef CONFIG_TIC_MQTT_QOS1
+// messages QoS1 confiés au client ( outbox ) et pas encore acquittés par le broker
+// une place de s_inflight_slots est prise avant esp_mqtt_client_enqueue(), rendue sur
+// MQTT_EVENT_PUBLISHED ( PUBACK ), MQTT_EVENT_DELETED ( expiré dans l'outbox ) ou après
+// CONFIG_TIC_MQTT_QOS1_EXPIRE_S sans réponse
+//
+// la place est réservée ( INFLIGHT_RESERVE ) avant esp_mqtt_client_enqueue() : un PUBACK traité
+// par la tâche du client avant l'enregistrement du msg_id est gardé dans la place réservée, et
+// appliqué à l'enregistrement. Seule mqtt_publish_task publie, une seule place est réservée à la fois
+#define INFLIGHT_RESERVE    -1
+
+typedef struct {
+    int msg_id;                 // 0 : place libre
+    int64_t enqueued_us;
+    int early_msg_id;           // réponse reçue pendant la réservation, 0 si aucune
+    bool early_acked;
+} inflight_t;
+
+static inflight_t s_inflight[CONFIG_TIC_MQTT_QOS1_WINDOW];
+static SemaphoreHandle_t s_inflight_slots = NULL;
+static mqtt_qos1_stats_t s_qos1_stats = {0};
+static portMUX_TYPE s_inflight_spinlock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+
+#if defined(CONFIG_TIC_MQTT5_TOPIC_ALIAS_MAX) && CONFIG_TIC_MQTT5_TOPIC_ALIAS_MAX > 0
+#define TOPIC_ALIAS
+// alias MQTT 5 des topics publiés, alias = index + 1, utilisé seulement par mqtt_publish_task
+// un alias est attribué au 1er message d'un topic, puis déclaré au broker à chaque connexion
+// par le 1er message qui l'utilise ( topic complet et alias ), les suivants n'envoient que l'alias
+typedef struct {
+    char topic[MQTT_TOPIC_BUFFER_SIZE];
+    bool registered;            // déclaré au broker depuis la connexion
+} topic_alias_t;
+
+static topic_alias_t s_aliases[CONFIG_TIC_MQTT5_TOPIC_ALIAS_MAX];
+static size_t s_nb_aliases = 0;
+static volatile bool s_aliases_reset = false;       // nouvelle connexion, mis par mqtt_event_handler()
+static bool s_aliases_disabled = false;             // refusés par le broker pendant cette connexion
+static mqtt_alias_stats_t s_alias_stats = {0};
+static portMUX_TYPE s_alias_spinlock = portMUX_INITIALIZER_UNLOCKED;
+#endif
 
 // paramètres de connexion au broker mqtt
 static psk_hint_key_t s_psk_hint_key = {0};
 static esp_mqtt_client_config_t s_mqtt_cfg = {
-        .broker.verification.psk_hint_key = &s_psk_hint_key
+        .broker.verification.psk_hint_key = &s_psk_hint_key,
+#ifdef CONFIG_TIC_MQTT5
+        .session.protocol_ver = MQTT_PROTOCOL_V_5,
+#endif
+#ifdef CONFIG_TIC_MQTT_QOS1
+        .session.message_retransmit_timeout = CONFIG_TIC_MQTT_QOS1_RETRANSMIT_MS,
+#endif
 };
 
 static void log_error_if_nonzero(const char *message, int error_code)
@@ -42,48 +102,107 @@ static void log_error_if_nonzero(const char *message, int error_code)
     }
 }
 
-// pour le debug
-//static int32_t s_allocated_msg = 0;
 // Alloue/libere un mqtt_msg_t  
 // pour la communication entre tâches process.c et mqtt.c
-mqtt_msg_t * mqtt_msg_alloc()
+// les messages sont préalloués une fois pour toutes, pas de malloc() à chaque trame
+
+// message et ses buffers, dans un seul bloc
+typedef struct {
+    mqtt_msg_t msg;
+    char topic[MQTT_TOPIC_BUFFER_SIZE];
+    char payload[MQTT_PAYLOAD_BUFFER_SIZE];
+} mqtt_msg_slot_t;
+
+// pointeurs vers les messages disponibles
+static QueueHandle_t s_free_msgs = NULL;
+
+// bloc unique contenant tous les messages du pool
+static mqtt_msg_slot_t *s_msg_slots = NULL;
+
+static mqtt_msg_pool_stats_t s_pool_stats = {0};
+static portMUX_TYPE s_pool_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+
+tic_error_t mqtt_msg_pool_init()
 {
-    mqtt_msg_t *msg = calloc( 1, sizeof(mqtt_msg_t) );
-    char *topic = calloc( 1, MQTT_TOPIC_BUFFER_SIZE );
-    char *payload = calloc( 1, MQTT_PAYLOAD_BUFFER_SIZE );
+    assert( s_msg_slots == NULL );    // already initialized ?
+
+    s_msg_slots = calloc( CONFIG_TIC_MQTT_MSG_POOL_SIZE, sizeof(mqtt_msg_slot_t) );
+    s_free_msgs = xQueueCreate( CONFIG_TIC_MQTT_MSG_POOL_SIZE, sizeof(mqtt_msg_t *) );
+    if( s_msg_slots == NULL || s_free_msgs == NULL )
+    {
+        ESP_LOGE( TAG, "mqtt_msg_pool_init() failed (out of memory ?)" );
+        return TIC_ERR_APP_INIT;
+    }
+
+    for( int i=0; i<CONFIG_TIC_MQTT_MSG_POOL_SIZE; i++ )
+    {
+        mqtt_msg_slot_t *slot = &(s_msg_slots[i]);
+        slot->msg.topic = slot->topic;
+        slot->msg.payload = slot->payload;
+        mqtt_msg_t *msg = &(slot->msg);
+        xQueueSend( s_free_msgs, &msg, 0 );
+    }
+    s_pool_stats.pool_size = CONFIG_TIC_MQTT_MSG_POOL_SIZE;
+    ESP_LOGI( TAG, "%d messages de %d bytes préalloués", CONFIG_TIC_MQTT_MSG_POOL_SIZE, sizeof(mqtt_msg_slot_t) );
+    return TIC_OK;
+}
+
 
-    if ( msg==NULL ||topic==NULL || payload==NULL )
+mqtt_msg_t * mqtt_msg_alloc()
+{
+    mqtt_msg_t *msg = NULL;
+    if( s_free_msgs == NULL || xQueueReceive( s_free_msgs, &msg, 0 ) != pdTRUE )
     {
-        ESP_LOGE( TAG, "mqtt_msg_alloc() failed (out of memory ?)");
-        free(topic);
-        free(payload);
-        free(msg);
+        taskENTER_CRITICAL( &s_pool_spinlock );
+        s_pool_stats.alloc_failures++;
+        taskEXIT_CRITICAL( &s_pool_spinlock );
+        ESP_LOGE( TAG, "mqtt_msg_alloc() failed (pool vide)");
         return NULL;
     }
-    msg->topic = topic;
-    msg->payload = payload;
-    //s_allocated_msg += 1;
-    // ESP_LOGD( TAG, "mqtt_msg_alloc()=%p   nb_msg_alloues=%"PRIi32, msg, s_allocated_msg );
+
+    // les buffers ne sont pas effacés : topic et payload sont entièrement réécrits par process.c
+    msg->topic[0] = '\0';
+    msg->payload[0] = '\0';
+    msg->payload_len = 0;
+    msg->binaire = false;
+    msg->par_etiquette = false;
+
+    taskENTER_CRITICAL( &s_pool_spinlock );
+    s_pool_stats.in_use++;
+    if( s_pool_stats.in_use > s_pool_stats.max_in_use )
+    {
+        s_pool_stats.max_in_use = s_pool_stats.in_use;
+    }
+    taskEXIT_CRITICAL( &s_pool_spinlock );
     return msg;
 }
 
+
 void mqtt_msg_free(mqtt_msg_t *msg)
 {
     if( msg == NULL)
         return;
 
-    if( msg->topic != NULL )
-    { 
-        free( msg->topic);
-        msg->topic = NULL;
-    }
-    if( msg->payload != NULL )
-    { 
-        free( msg->payload);
-        msg->payload = NULL;
+    assert( (mqtt_msg_slot_t *)msg >= s_msg_slots && (mqtt_msg_slot_t *)msg < s_msg_slots + CONFIG_TIC_MQTT_MSG_POOL_SIZE );
+    if( xQueueSend( s_free_msgs, &msg, 0 ) != pdTRUE )
+    {
+        ESP_LOGE( TAG, "mqtt_msg_free(%p) : message libéré deux fois ?", msg );
+        return;
     }
-    free( msg );
-    //s_allocated_msg -= 1;
+
+    taskENTER_CRITICAL( &s_pool_spinlock );
+    s_pool_stats.in_use--;
+    taskEXIT_CRITICAL( &s_pool_spinlock );
+}
+
+
+void mqtt_msg_pool_get_stats( mqtt_msg_pool_stats_t *stats )
+{
+    assert( stats );
+    taskENTER_CRITICAL( &s_pool_spinlock );
+    memcpy( stats, &s_pool_stats, sizeof(*stats) );
+    taskEXIT_CRITICAL( &s_pool_spinlock );
 }
 
 
@@ -106,6 +225,171 @@ tic_error_t mqtt_receive_msg( mqtt_msg_t *msg )
 }
 
 
+#ifdef CONFIG_TIC_MQTT_QOS1
+// libère la place du message msg_id, appelé depuis mqtt_event_handler()
+static void inflight_done( int msg_id, bool acked )
+{
+    if( msg_id <= 0 )
+    {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    bool found = false;
+    inflight_t *reserve = NULL;
+    taskENTER_CRITICAL( &s_inflight_spinlock );
+    for( int i = 0; i < CONFIG_TIC_MQTT_QOS1_WINDOW; i++ )
+    {
+        inflight_t *f = &(s_inflight[i]);
+        if( f->msg_id == INFLIGHT_RESERVE )
+        {
+            reserve = f;
+        }
+        if( f->msg_id != msg_id )
+        {
+            continue;
+        }
+        found = true;
+        f->msg_id = 0;
+        s_qos1_stats.in_flight--;
+        if( acked )
+        {
+            uint32_t ms = ( now - f->enqueued_us ) / 1000;
+            s_qos1_stats.acked++;
+            s_qos1_stats.ack_ms_last = ms;
+            if( ms > s_qos1_stats.ack_ms_max )
+            {
+                s_qos1_stats.ack_ms_max = ms;
+            }
+            // estimation : le client réémet le PUBLISH ( DUP ) à chaque délai de retransmission écoulé,
+            // il ne signale pas les réémissions elles-mêmes
+            s_qos1_stats.retransmits_est += ms / CONFIG_TIC_MQTT_QOS1_RETRANSMIT_MS;
+        }
+        else
+        {
+            s_qos1_stats.expired++;
+        }
+        break;
+    }
+    if( !found && reserve != NULL )
+    {
+        // réponse au message en cours d'enregistrement par publish_qos1()
+        reserve->early_msg_id = msg_id;
+        reserve->early_acked = acked;
+    }
+    taskEXIT_CRITICAL( &s_inflight_spinlock );
+    if( found )
+    {
+        xSemaphoreGive( s_inflight_slots );
+    }
+    if( found && !acked )
+    {
+        process_force_keyframe();     // le broker n'a peut-être pas reçu la trame delta
+    }
+}
+
+
+// libère les messages sans réponse depuis trop longtemps ( all : tous, l'outbox a été détruite )
+static void inflight_expire( bool all )
+{
+    int64_t limit = esp_timer_get_time() - (int64_t)CONFIG_TIC_MQTT_QOS1_EXPIRE_S * 1000000;
+    for( int i = 0; i < CONFIG_TIC_MQTT_QOS1_WINDOW; i++ )
+    {
+        taskENTER_CRITICAL( &s_inflight_spinlock );
+        int msg_id = s_inflight[i].msg_id;
+        bool expired = msg_id > 0 && ( all || s_inflight[i].enqueued_us < limit );
+        taskEXIT_CRITICAL( &s_inflight_spinlock );
+        if( expired )
+        {
+            ESP_LOGW( TAG, "message QoS1 msg_id=%d non acquitté", msg_id );
+            inflight_done( msg_id, false );
+        }
+    }
+}
+
+
+// confie le message à l'outbox du client, sans attendre l'envoi sur le socket
+static int publish_qos1( const char *topic, const char *data, int len, int retain )
+{
+#ifdef CONFIG_TIC_SPOOL
+    // fenêtre pleine : le message part dans le spool, s'il est utilisable
+    TickType_t wait = s_spool ? 0 : pdMS_TO_TICKS( CONFIG_TIC_MQTT_QOS1_WAIT_MS );
+#else
+    TickType_t wait = pdMS_TO_TICKS( CONFIG_TIC_MQTT_QOS1_WAIT_MS );
+#endif
+    if( xSemaphoreTake( s_inflight_slots, wait ) != pdTRUE )
+    {
+        taskENTER_CRITICAL( &s_inflight_spinlock );
+        s_qos1_stats.window_full++;
+        taskEXIT_CRITICAL( &s_inflight_spinlock );
+        return -1;
+    }
+
+    // le sémaphore garantit une place libre
+    inflight_t *f = NULL;
+    taskENTER_CRITICAL( &s_inflight_spinlock );
+    for( int i = 0; i < CONFIG_TIC_MQTT_QOS1_WINDOW && f == NULL; i++ )
+    {
+        if( s_inflight[i].msg_id == 0 )
+        {
+            f = &(s_inflight[i]);
+            f->msg_id = INFLIGHT_RESERVE;
+            f->early_msg_id = 0;
+            f->enqueued_us = esp_timer_get_time();
+        }
+    }
+    taskEXIT_CRITICAL( &s_inflight_spinlock );
+    if( f == NULL )
+    {
+        ESP_LOGE( TAG, "fenêtre QoS1 incohérente avec le sémaphore" );
+        xSemaphoreGive( s_inflight_slots );
+        return -1;
+    }
+
+    // le PUBACK peut être traité par la tâche du client avant le retour d'esp_mqtt_client_enqueue()
+    int msg_id = esp_mqtt_client_enqueue( s_esp_client, topic, data, len, 1, retain, true );
+
+    taskENTER_CRITICAL( &s_inflight_spinlock );
+    bool early = ( msg_id > 0 && f->early_msg_id == msg_id );
+    bool early_acked = f->early_acked;
+    if( msg_id > 0 )
+    {
+        f->msg_id = msg_id;
+        s_qos1_stats.enqueued++;
+        s_qos1_stats.in_flight++;
+    }
+    else
+    {
+        f->msg_id = 0;
+        s_qos1_stats.rejected++;
+    }
+    taskEXIT_CRITICAL( &s_inflight_spinlock );
+
+    if( msg_id <= 0 )
+    {
+        xSemaphoreGive( s_inflight_slots );
+        return -1;
+    }
+    if( early )
+    {
+        inflight_done( msg_id, early_acked );
+    }
+    return msg_id;
+}
+#endif
+
+
+void mqtt_qos1_get_stats( mqtt_qos1_stats_t *stats )
+{
+#ifdef CONFIG_TIC_MQTT_QOS1
+    taskENTER_CRITICAL( &s_inflight_spinlock );
+    *stats = s_qos1_stats;
+    taskEXIT_CRITICAL( &s_inflight_spinlock );
+#else
+    memset( stats, 0, sizeof(*stats) );
+#endif
+}
+
+
 /*
  * @brief Event handler registered to receive MQTT events
  *
@@ -129,9 +413,15 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
     case MQTT_EVENT_CONNECTED:
         ESP_LOGI(TAG, "MQTT_EVENT_CONNECTED to %s", (s_mqtt_cfg.broker.address.uri) );
         send_event_mqtt( "connected" );
+        s_connected = true;
+#ifdef TOPIC_ALIAS
+        s_aliases_reset = true;       // les alias ne valent que pour une connexion
+#endif
+        process_force_keyframe();     // le broker n'a peut-être pas reçu les dernières trames delta
         break;
     case MQTT_EVENT_DISCONNECTED:
         ESP_LOGI(TAG, "MQTT_EVENT_DISCONNECTED");
+        s_connected = false;
         send_event_mqtt( "connecting..." );
         break;
     case MQTT_EVENT_SUBSCRIBED:
@@ -141,7 +431,16 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
         ESP_LOGI(TAG, "MQTT_EVENT_UNSUBSCRIBED, msg_id=%d", event->msg_id);
         break;
     case MQTT_EVENT_PUBLISHED:
-        ESP_LOGI(TAG, "MQTT_EVENT_PUBLISHED, msg_id=%d", event->msg_id);
+        ESP_LOGD(TAG, "MQTT_EVENT_PUBLISHED, msg_id=%d", event->msg_id);
+#ifdef CONFIG_TIC_MQTT_QOS1
+        inflight_done( event->msg_id, true );
+#endif
+        break;
+    case MQTT_EVENT_DELETED:
+        ESP_LOGW(TAG, "MQTT_EVENT_DELETED, msg_id=%d expiré dans l'outbox", event->msg_id);
+#ifdef CONFIG_TIC_MQTT_QOS1
+        inflight_done( event->msg_id, false );
+#endif
         break;
     case MQTT_EVENT_DATA:
         ESP_LOGI(TAG, "MQTT_EVENT_DATA");
@@ -254,6 +553,10 @@ static void mqtt_client_task( void *pvParams )
             {
                 ESP_LOGD( TAG, "client mqtt destroyed" );
                 s_esp_client = NULL;
+                s_connected = false;
+#ifdef CONFIG_TIC_MQTT_QOS1
+                inflight_expire( true );    // l'outbox a été détruite avec le client
+#endif
             }
         }
         s_esp_client = esp_mqtt_client_init (&s_mqtt_cfg);
@@ -287,18 +590,228 @@ static void mqtt_client_task( void *pvParams )
 }
 
 
+#ifdef TOPIC_ALIAS
+// alias du topic, 0 si la table est pleine ou si le broker les refuse
+static uint16_t topic_alias( const char *topic, bool *registered )
+{
+    if( s_aliases_reset )
+    {
+        s_aliases_reset = false;
+        s_aliases_disabled = false;
+        for( size_t i = 0; i < s_nb_aliases; i++ )
+        {
+            s_aliases[i].registered = false;
+        }
+    }
+    if( s_aliases_disabled )
+    {
+        return 0;
+    }
+    for( size_t i = 0; i < s_nb_aliases; i++ )
+    {
+        if( strcmp( s_aliases[i].topic, topic ) == 0 )
+        {
+            *registered = s_aliases[i].registered;
+            return i + 1;
+        }
+    }
+    if( s_nb_aliases >= CONFIG_TIC_MQTT5_TOPIC_ALIAS_MAX || strlen( topic ) >= MQTT_TOPIC_BUFFER_SIZE )
+    {
+        return 0;
+    }
+    strcpy( s_aliases[s_nb_aliases].topic, topic );
+    s_aliases[s_nb_aliases].registered = false;
+    *registered = false;
+    s_nb_aliases++;
+    return s_nb_aliases;
+}
+
+
+void mqtt_alias_get_stats( mqtt_alias_stats_t *stats )
+{
+    taskENTER_CRITICAL( &s_alias_spinlock );
+    *stats = s_alias_stats;
+    taskEXIT_CRITICAL( &s_alias_spinlock );
+    stats->aliases = s_nb_aliases;
+    stats->alias_max = CONFIG_TIC_MQTT5_TOPIC_ALIAS_MAX;
+}
+
+
+// publication QoS0 avec l'alias du topic
+static int publish_alias( const char *topic, const char *data, int len, int retain )
+{
+    bool registered = false;
+    uint16_t alias = topic_alias( topic, &registered );
+
+    // la propriété s'applique au PUBLISH suivant, remise à 0 quand le topic n'a pas d'alias
+    esp_mqtt5_publish_property_config_t property = { .topic_alias = alias };
+    esp_mqtt5_client_set_publish_property( s_esp_client, &property );
+    int ret = esp_mqtt_client_publish( s_esp_client, ( alias && registered ) ? "" : topic, data, len, 0, retain );
+    if( ret < 0 && alias )
+    {
+        // alias au delà du maximum annoncé par le broker : topics complets jusqu'à la reconnexion
+        ESP_LOGW( TAG, "alias %u refusé, topics complets jusqu'à la prochaine connexion", alias );
+        s_aliases_disabled = true;
+        property.topic_alias = 0;
+        esp_mqtt5_client_set_publish_property( s_esp_client, &property );
+        return esp_mqtt_client_publish( s_esp_client, topic, data, len, 0, retain );
+    }
+
+    if( ret >= 0 && alias )
+    {
+        taskENTER_CRITICAL( &s_alias_spinlock );
+        if( registered )
+        {
+            s_alias_stats.hits++;
+            s_alias_stats.topic_bytes_saved += strlen( topic );
+        }
+        else
+        {
+            s_alias_stats.registrations++;
+        }
+        taskEXIT_CRITICAL( &s_alias_spinlock );
+        s_aliases[alias - 1].registered = true;
+    }
+    return ret;
+}
+#else
+void mqtt_alias_get_stats( mqtt_alias_stats_t *stats )
+{
+    memset( stats, 0, sizeof(*stats) );
+}
+#endif
+
+
+static int publish_one( const char *topic, const char *data, int len, int retain )
+{
+#if defined(CONFIG_TIC_MQTT_QOS1)
+    return publish_qos1( topic, data, len, retain );
+#elif defined(TOPIC_ALIAS)
+    return publish_alias( topic, data, len, retain );
+#else
+    return esp_mqtt_client_publish( s_esp_client, topic, data, len, 0, retain );
+#endif
+}
+
+
+// un message retenu par etiquette, sur le topic du message suivi de /<etiquette>
+// payload : suite de ( etiquette \0 valeur \0 ), voir process.c
+static int publish_labels( const mqtt_msg_t *msg )
+{
+    char topic[MQTT_TOPIC_BUFFER_SIZE];
+    size_t base = strnlen( msg->topic, sizeof(topic) - 2 );
+    memcpy( topic, msg->topic, base );
+    topic[base++] = '/';
+
+    int ret = 0;
+    size_t pos = 0;
+    while( pos < msg->payload_len )
+    {
+        const char *label = &(msg->payload[pos]);
+        size_t label_len = strnlen( label, msg->payload_len - pos );
+        if( label_len + 1 >= msg->payload_len - pos )
+        {
+            ESP_LOGE( TAG, "payload par etiquette tronqué" );
+            break;
+        }
+        const char *val = label + label_len + 1;
+        size_t val_len = strnlen( val, msg->payload_len - pos - label_len - 1 );
+        pos += label_len + val_len + 2;
+        if( base + label_len >= sizeof(topic) || val_len == 0 )
+        {
+            continue;       // un payload vide effacerait la valeur retenue
+        }
+
+        // + # et / sont interdits dans un nom d'etiquette publié
+        for( size_t i = 0; i < label_len; i++ )
+        {
+            char c = label[i];
+            topic[base + i] = ( c == '+' || c == '#' || c == '/' ) ? '_' : c;
+        }
+        topic[base + label_len] = '\0';
+
+        ret = publish_one( topic, val, val_len, 1 );
+        if( ret < 0 )
+        {
+            return ret;     // republié en entier depuis le spool : les valeurs retenues sont écrasées à l'identique
+        }
+    }
+    return ret;
+}
+
+
+static int publish( const mqtt_msg_t *msg )
+{
+    if( !s_esp_client || !s_connected )
+    {
+        return -1;
+    }
+    if( msg->par_etiquette )
+    {
+        return publish_labels( msg );
+    }
+    return publish_one( msg->topic, msg->payload, msg->payload_len, 0 );
+}
+
+
+#ifdef CONFIG_TIC_SPOOL
+// buffers des messages relus dans le spool
+static char s_replay_topic[MQTT_TOPIC_BUFFER_SIZE];
+static char s_replay_payload[MQTT_PAYLOAD_BUFFER_SIZE];
+
+// republie au plus CONFIG_TIC_SPOOL_REPLAY_BATCH messages du spool, du plus ancien au plus récent
+static void replay_spool()
+{
+    mqtt_msg_t replay = { .topic = s_replay_topic, .payload = s_replay_payload };
+    for( int i = 0; i < CONFIG_TIC_SPOOL_REPLAY_BATCH && s_connected; i++ )
+    {
+        if( spool_peek( &replay ) != TIC_OK )
+        {
+            break;      // spool vide
+        }
+        if( publish( &replay ) < 0 )
+        {
+            break;      // le message reste dans le spool
+        }
+        spool_consume();
+    }
+    spool_commit();
+}
+#endif
+
+
 static void mqtt_publish_task( void *pvParams )
 {
     ESP_LOGI( TAG, "mqtt_publish_task()");
 
-    //TickType_t max_ticks = MQTT_TIC_TIMEOUT_SEC * 1000 / portTICK_PERIOD_MS; 
+#if defined(CONFIG_TIC_SPOOL)
+    TickType_t max_ticks = pdMS_TO_TICKS( CONFIG_TIC_SPOOL_REPLAY_PERIOD_MS );
+    TickType_t last_replay = 0;
+#elif defined(CONFIG_TIC_MQTT_QOS1)
+    TickType_t max_ticks = pdMS_TO_TICKS( 1000 );     // recherche des messages QoS1 expirés
+#else
+    TickType_t max_ticks = portMAX_DELAY;
+#endif
     mqtt_msg_t *msg = NULL;
     for(;;)
     {
         mqtt_msg_free(msg);    // libère les buffers alloués par process_task
         msg = NULL;
 
-        BaseType_t msg_received = xQueueReceive( s_to_mqtt, &msg, portMAX_DELAY );
+#ifdef CONFIG_TIC_SPOOL
+        // rattrape le retard de façon progressive, entre deux messages reçus
+        if( s_spool && s_connected && !spool_is_empty() && xTaskGetTickCount() - last_replay >= max_ticks )
+        {
+            replay_spool();
+            last_replay = xTaskGetTickCount();
+        }
+#endif
+
+#ifdef CONFIG_TIC_MQTT_QOS1
+        inflight_expire( false );
+#endif
+
+        BaseType_t msg_received = xQueueReceive( s_to_mqtt, &msg, max_ticks );
         if( msg_received != pdTRUE )
         {
             continue;   // timeout
@@ -313,19 +826,37 @@ static void mqtt_publish_task( void *pvParams )
             ESP_LOGD( TAG, "Topic MQTT absent");
             continue;
         }
-        if( msg->payload==NULL || msg->payload[0]=='\0' )
+        if( msg->payload==NULL || (msg->payload_len==0 && msg->payload[0]=='\0') )
         {
             ESP_LOGD( TAG, "Payload MQTT absent");
             continue;
         }
 
         ESP_LOGD( TAG, "mqtt topic = %s", msg->topic );
-        ESP_LOGD( TAG, "mqtt payload = %s", msg->payload );
+        if( msg->binaire )
+        {
+            ESP_LOGD( TAG, "mqtt payload binaire, %d bytes", msg->payload_len );
+        }
+        else
+        {
+            ESP_LOGD( TAG, "mqtt payload = %s", msg->payload );
+        }
 
-        if( s_esp_client )
+        bool perdu;
+#ifdef CONFIG_TIC_SPOOL
+        if( s_spool )
+        {
+            // tant que le spool n'est pas vide, les nouveaux messages passent derrière pour garder l'ordre
+            perdu = ( !spool_is_empty() || publish( msg ) < 0 ) && spool_append( msg ) != TIC_OK;
+        }
+        else
+#endif
         {
-            esp_mqtt_client_publish( s_esp_client, msg->topic, msg->payload, 0, 0, 0);
-            // ignore erreurs
+            perdu = ( publish( msg ) < 0 );
+        }
+        if( perdu )
+        {
+            process_force_keyframe();     // message perdu : les trames delta suivantes ne suffisent plus
         }
     }
     ESP_LOGE( TAG, "fatal: mqtt_publish_task exited" );
@@ -359,6 +890,25 @@ tic_error_t mqtt_task_start( int dummy )
         return TIC_ERR_APP_INIT;
     }
 
+#ifdef CONFIG_TIC_SPOOL
+    // sans spool, les messages sont simplement perdus quand le broker est injoignable
+    tic_error_t spool_err = spool_init();
+    s_spool = ( spool_err == TIC_OK );
+    if( !s_spool )
+    {
+        ESP_LOGE( TAG, "spool_init() erreur %d : publication sans spool, messages perdus si le broker est injoignable", spool_err );
+    }
+#endif
+#ifdef CONFIG_TIC_MQTT_QOS1
+    s_inflight_slots = xSemaphoreCreateCounting( CONFIG_TIC_MQTT_QOS1_WINDOW, CONFIG_TIC_MQTT_QOS1_WINDOW );
+    if( s_inflight_slots==NULL )
+    {
+        ESP_LOGE( TAG, "xSemaphoreCreateCounting() failed" );
+        return TIC_ERR_APP_INIT;
+    }
+    s_qos1_stats.window = CONFIG_TIC_MQTT_QOS1_WINDOW;
+#endif
+
     BaseType_t task_created;
 
     // en mode dummy, le client ne s'executera pas et s_esp_client restera NULL à tout jamais
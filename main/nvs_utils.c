@@ -184,6 +184,60 @@ tic_error_t console_nvs_get_blob( const char* key, char **out_buf, size_t *out_l
 }
 
 
+// TIC_ERR_NVS si la clé est absente, out inchangé
+tic_error_t console_nvs_get_u8( const char* key, uint8_t *out )
+{
+    nvs_handle_t nvs;
+    esp_err_t err;
+
+    err = nvs_open(TIC_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (err != ESP_OK) {
+        return TIC_ERR_NVS;
+    }
+
+    err = nvs_get_u8(nvs, key, out);
+    nvs_close(nvs);
+    return ( err == ESP_OK ) ? TIC_OK : TIC_ERR_NVS;
+}
+
+
+// blob de taille connue, sans allocation. TIC_ERR_NVS si la clé est absente ou de taille différente
+tic_error_t console_nvs_get_blob_fixed( const char* key, void *out, size_t len )
+{
+    nvs_handle_t nvs;
+    esp_err_t err;
+
+    err = nvs_open(TIC_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (err != ESP_OK) {
+        return TIC_ERR_NVS;
+    }
+
+    size_t stored_len = len;
+    err = nvs_get_blob(nvs, key, out, &stored_len);
+    nvs_close(nvs);
+    return ( err == ESP_OK && stored_len == len ) ? TIC_OK : TIC_ERR_NVS;
+}
+
+
+tic_error_t console_nvs_set_blob( const char* key, const void *data, size_t len )
+{
+    nvs_handle_t nvs;
+    esp_err_t err;
+
+    err = nvs_open(TIC_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) {
+        return TIC_ERR_NVS;
+    }
+
+    err = nvs_set_blob(nvs, key, data, len);
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    return ( err == ESP_OK ) ? TIC_OK : TIC_ERR_NVS;
+}
+
+
 // alloue un buffer qui doit être libéré par l'appelant 
 tic_error_t console_nvs_get_blob_as_string( const char* key, char **out_buf )
 {
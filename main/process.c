@@ -10,10 +10,18 @@
 #include "freertos/event_groups.h"
 
 #include "esp_log.h"
+#include "esp_cpu.h"     // esp_cpu_get_cycle_count()
+#include "esp_timer.h"
 
 #include "tic_types.h"
 #include "tic_config.h"
 #include "dataset.h"
+#include "json_writer.h"
+#include "cbor_writer.h"
+#include "delta.h"
+#include "batch.h"
+#include "nvs_utils.h"
+#include "frame_pool.h"
 #include "event_loop.h"
 #include "mqtt.h"        // pour mqtt_msg_alloc() mqtt_msg_free()
 #include "process.h"
@@ -25,53 +33,60 @@ static QueueHandle_t s_to_process = NULL;
 
 
 static const char *FORMAT_ISO8601 = "%Y-%m-%dT%H:%M:%S%z";
-static const char *FORMAT_NUMERIC_SANS_HORODATE = "  \"%s\":{\"val\":%"PRIi32"}";
-static const char *FORMAT_NUMERIC_AVEC_HORODATE = "  \"%s\":{\"horodate\":\"%s\", \"val\":%"PRIi32"}";
-static const char *FORMAT_STRING_SANS_HORODATE = "  \"%s\":{\"val\":\"%s\"}";
-static const char *FORMAT_STRING_AVEC_HORODATE = "  \"%s\":{\"horodate\":\"%s\", \"val\":\"%s\"}";
 
+// formats publiés pour chaque trame, clé NVS TIC_NVS_PAYLOAD_FORMAT ou Kconfig
+#define PAYLOAD_JSON   0x01
+#define PAYLOAD_CBOR   0x02
+static uint8_t s_payload_formats = PAYLOAD_JSON;
 
+// durée de la serialisation JSON, pour process_get_stats()
+static process_stats_t s_stats = {0};
+static portMUX_TYPE s_stats_spinlock = portMUX_INITIALIZER_UNLOCKED;
 
+// modèle JSON de la dernière trame, utilisé seulement par la tâche process
+static json_template_t s_template;
 
-static tic_error_t set_topic (char *buf, size_t size, const tic_data_t *data )
-{
-    assert(data->id_compteur);
-    snprintf ( buf, size, MQTT_TOPIC_FORMAT, data->id_compteur );  // ignore errors
-    return TIC_OK;
-}
+#ifdef CONFIG_TIC_PUBLISH_DELTA
+// dernière valeur publiée de chaque etiquette, utilisé seulement par la tâche process
+static delta_state_t s_delta;
+static bool s_force_keyframe = false;      // demandé par mqtt.c, protégé par s_stats_spinlock
+#endif
 
+#ifdef CONFIG_TIC_BATCH
+// lots en cours, un par format ( BATCH_JSON, BATCH_CBOR ), utilisés seulement par la tâche process
+static batch_t s_batches[2];
+// document d'une trame, avant sa copie dans le lot
+static char s_doc[MQTT_PAYLOAD_BUFFER_SIZE];
+#endif
 
-static size_t printf_ds( char *buf, size_t size, const dataset_t *ds )
-{
-    // garde seulement les flags de format
-    tic_dataset_flags_t flags =  (ds->flags) & (TIC_DS_NUMERIQUE|TIC_DS_HAS_TIMESTAMP);
-    int32_t val_int=-1;
 
-    // convertit en int pour un formattage printf correct 
-    if( flags & TIC_DS_NUMERIQUE )
+// topic du compteur, formaté seulement quand l'identifiant change, utilisé seulement par la tâche process
+static id_compteur_t s_topic_id = "";
+static char s_topic_base[MQTT_TOPIC_BUFFER_SIZE];
+static size_t s_topic_base_len = 0;
+
+
+static tic_error_t set_topic (char *buf, size_t size, const tic_data_t *data, const char *suffix )
+{
+    assert(data->id_compteur);
+    if( s_topic_base_len == 0 || strncmp( s_topic_id, data->id_compteur, sizeof(s_topic_id) ) != 0 )
     {
-        // TODO : check erreurs de conversion
-        val_int = strtol( ds->valeur, NULL, 10 );
+        strncpy( s_topic_id, data->id_compteur, sizeof(s_topic_id) );
+        int len = snprintf( s_topic_base, sizeof(s_topic_base), MQTT_TOPIC_FORMAT, data->id_compteur );
+        s_topic_base_len = ( len < 0 ) ? 0 : ( (size_t)len >= sizeof(s_topic_base) ) ? sizeof(s_topic_base) - 1 : len;
     }
 
-    size_t nb_wr=0;
-    switch( flags)
+    // base puis suffixe, tronqués à size comme snprintf()
+    size_t suffix_len = strlen( suffix );
+    size_t base_len = ( s_topic_base_len < size ) ? s_topic_base_len : size - 1;
+    if( base_len + suffix_len >= size )
     {
-        case 0:
-            nb_wr = snprintf( buf, size, FORMAT_STRING_SANS_HORODATE, ds->etiquette, ds->valeur);
-            break;
-        case TIC_DS_HAS_TIMESTAMP:
-            nb_wr = snprintf( buf, size, FORMAT_STRING_AVEC_HORODATE, ds->etiquette, ds->horodate, ds->valeur);
-            break;
-        case TIC_DS_NUMERIQUE:
-            nb_wr = snprintf( buf, size, FORMAT_NUMERIC_SANS_HORODATE, ds->etiquette, val_int);
-            break;
-        case TIC_DS_NUMERIQUE|TIC_DS_HAS_TIMESTAMP:
-            nb_wr = snprintf( buf, size, FORMAT_NUMERIC_AVEC_HORODATE, ds->etiquette, ds->horodate, val_int);
-            break;
+        suffix_len = size - 1 - base_len;
     }
-
-   return nb_wr;
+    memcpy( buf, s_topic_base, base_len );
+    memcpy( &(buf[base_len]), suffix, suffix_len );
+    buf[base_len + suffix_len] = '\0';
+    return TIC_OK;
 }
 
 
@@ -108,90 +123,281 @@ int compare_datasets( const dataset_t *ds1, const dataset_t *ds2 )
 }
 */
 
-static tic_error_t datasets_to_json( char *buf, size_t size, const dataset_t *ds )
+// serialisation en un seul passage, directement dans le payload du message
+static tic_error_t datasets_to_json( char *buf, size_t size, const tic_frame_t *frame, size_t *len )
 {
-    size_t pos = 0;
     char time_buf[30];
-    get_time_iso8601( time_buf, sizeof(time_buf) );
+    size_t time_len = get_time_iso8601( time_buf, sizeof(time_buf) );
+
+    json_writer_t jw;
+    json_init( &jw, buf, size );
+    JSON_RAW( &jw, "{\n\"esp_time\":" );
+    json_string( &jw, time_buf, time_len );
+    JSON_RAW( &jw, ",\n\"esp_free_mem\":" );
+    json_uint( &jw, esp_get_free_heap_size() );
+    JSON_RAW( &jw, ",\n" );
+    json_write_frame_template( &jw, &s_template, frame );
+    JSON_RAW( &jw, " }\n" );
+    return json_finish( &jw, len );
+}
+
+
+// même contenu que datasets_to_json(), en CBOR
+static tic_error_t datasets_to_cbor( char *buf, size_t size, const tic_frame_t *frame, size_t *len )
+{
+    cbor_writer_t cw;
+    cbor_init( &cw, (uint8_t *)buf, size );
+    cbor_write_frame( &cw, frame, time(NULL), esp_get_free_heap_size() );
+    return cbor_finish( &cw, len );
+}
 
-    pos += snprintf( &(buf[pos]), size-pos, "{\n\"esp_time\":\"%s\",\n\"esp_free_mem\":%"PRIu32",\n\"tic\" : {\n", time_buf, esp_get_free_heap_size() );
 
-    while( ds!=NULL && (size-pos) > 0 )
+static tic_error_t set_payload( char *buf, size_t size, tic_frame_t *frame, uint8_t format, size_t *len )
+{
+    if( format == PAYLOAD_CBOR )
+    {
+        tic_error_t err = datasets_to_cbor( buf, size, frame, len );
+        taskENTER_CRITICAL( &s_stats_spinlock );
+        s_stats.cbor_frames++;
+        s_stats.cbor_bytes_last = *len;
+        taskEXIT_CRITICAL( &s_stats_spinlock );
+        return err;
+    }
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    tic_error_t err = datasets_to_json( buf, size, frame, len );
+    uint32_t cycles = esp_cpu_get_cycle_count() - start;
+
+    taskENTER_CRITICAL( &s_stats_spinlock );
+    s_stats.json_frames++;
+    s_stats.json_cycles_last = cycles;
+    s_stats.json_cycles_total += cycles;
+    if( cycles > s_stats.json_cycles_max )
     {
-        // ignore les etiquettes non exportées 
-        if( (ds->flags & TIC_DS_PUBLISHED) == 0  )
+        s_stats.json_cycles_max = cycles;
+    }
+    s_stats.json_bytes_last = *len;
+    s_stats.json_template_hits = s_template.hits;
+    s_stats.json_template_rebuilds = s_template.rebuilds;
+    taskEXIT_CRITICAL( &s_stats_spinlock );
+    return err;
+}
+
+
+#ifdef CONFIG_TIC_TOPIC_PER_LABEL
+// etiquettes publiées de la trame, pour mqtt.c : suite de ( etiquette \0 valeur \0 )
+// valeur entière en décimal, texte tel quel, {"horodate":"...","val":...} pour une etiquette horodatée
+static tic_error_t datasets_to_labels( char *buf, size_t size, const tic_frame_t *frame, size_t *len )
+{
+    json_writer_t jw;
+    json_init( &jw, buf, size );
+    for( const dataset_t *ds = dataset_first( frame ); ds != NULL; ds = dataset_next( frame, ds ) )
+    {
+        if( (ds->flags & TIC_DS_PUBLISHED) == 0 )
         {
-            ds = ds->next;
             continue;
         }
-
-        // formatte la donnée en JSON
-        pos += printf_ds( &(buf[pos]), size-pos, ds );
-
-        // separateurs
-        if( pos >= (size-2) )     // -2 pour la virgule et le \n 
+        json_raw( &jw, dataset_etiquette( frame, ds ), ds->etiquette.len );
+        JSON_RAW( &jw, "\0" );
+        if( ds->flags & TIC_DS_HAS_TIMESTAMP )
+        {
+            JSON_RAW( &jw, "{\"horodate\":" );
+            json_string( &jw, dataset_horodate( frame, ds ), ds->horodate.len );
+            JSON_RAW( &jw, ",\"val\":" );
+            if( ds->type == TIC_TYPE_ENTIER )
+            {
+                json_int( &jw, ds->val.entier );
+            }
+            else
+            {
+                json_string( &jw, dataset_valeur( frame, ds ), ds->valeur.len );
+            }
+            JSON_RAW( &jw, "}" );
+        }
+        else if( ds->type == TIC_TYPE_ENTIER )
         {
-            ESP_LOGE( TAG, "JSON buffer overflow" );
-            return TIC_ERR_OVERFLOW;
+            json_int( &jw, ds->val.entier );
         }
-        if( ds->next != NULL) 
+        else
         {
-            buf[pos++] = ',';
+            json_raw( &jw, dataset_valeur( frame, ds ), ds->valeur.len );
         }
-        buf[pos++] = '\n';
+        JSON_RAW( &jw, "\0" );
+    }
+    return json_finish( &jw, len );
+}
+
 
-        ds = ds->next;
+// un message pour les etiquettes modifiées de la trame, publiées par mqtt.c sur home/elec/<compteur>/<etiquette>
+static tic_error_t publish_labels( tic_frame_t *frame, const tic_data_t *data )
+{
+    mqtt_msg_t *msg = mqtt_msg_alloc();
+    if( msg == NULL)
+    {
+        return TIC_ERR;     // pool vide, erreur logguee dans mqtt_msg_alloc()
     }
 
-    // termine le tableau et l'objet JSON racine
-    pos += snprintf( &(buf[pos]), size-pos, "} }\n" );
-    if( pos > (size-1) )
+    set_topic( msg->topic, MQTT_TOPIC_BUFFER_SIZE, data, "" );
+    msg->binaire = true;
+    msg->par_etiquette = true;
+    tic_error_t err = datasets_to_labels( msg->payload, MQTT_PAYLOAD_BUFFER_SIZE, frame, &(msg->payload_len) );
+    if( err != TIC_OK || msg->payload_len == 0 )
+    {
+        if( err != TIC_OK )
+        {
+            ESP_LOGE (TAG, "datasets_to_labels() erreur %d", err);
+        }
+        mqtt_msg_free( msg );       // aucune etiquette modifiée
+        return err;
+    }
+    err = mqtt_receive_msg(msg);
+    if( err != TIC_OK )
     {
-        ESP_LOGE( TAG, "JSON buffer overflow" );
-        return TIC_ERR_OVERFLOW;
+        mqtt_msg_free( msg );
+    }
+    return err;
+}
+#endif
+
+
+#if !defined(CONFIG_TIC_BATCH) && !defined(CONFIG_TIC_TOPIC_PER_LABEL)
+static tic_error_t build_mqtt_msg( mqtt_msg_t *msg, tic_frame_t *frame, const tic_data_t *data, uint8_t format )
+{
+    tic_error_t err;
+    err = set_topic( msg->topic, MQTT_TOPIC_BUFFER_SIZE, data, ( format == PAYLOAD_CBOR ) ? MQTT_TOPIC_CBOR_SUFFIX : "" );
+    if( err != TIC_OK )
+    {
+        ESP_LOGD( TAG, "Erreur lors de la création du topic MQTT");
+        return err;
+    }
+
+    msg->binaire = ( format == PAYLOAD_CBOR );
+    err = set_payload( msg->payload, MQTT_PAYLOAD_BUFFER_SIZE, frame, format, &(msg->payload_len) );
+    if( err != TIC_OK )
+    {
+        ESP_LOGD( TAG, "Erreur lors de la création du payload MQTT");
+        return err;
     }
     return TIC_OK;
+
+}
+
+
+// un message par format, envoyé à mqtt_task
+static tic_error_t publish( tic_frame_t *frame, const tic_data_t *data, uint8_t format )
+{
+    mqtt_msg_t *msg = mqtt_msg_alloc();
+    if( msg == NULL)
+    {
+        return TIC_ERR;     // pool vide, erreur logguee dans mqtt_msg_alloc()
+    }
+
+    tic_error_t err = build_mqtt_msg( msg, frame, data, format );
+    if( err != TIC_OK )
+    {
+        ESP_LOGE (TAG, "build_mqtt_msg() erreur %d", err);
+        mqtt_msg_free( msg );
+        return err;
+    }
+
+    // envoie le message à mqtt_task, qui le libèrera
+    err = mqtt_receive_msg(msg);
+    if( err != TIC_OK )
+    {
+        mqtt_msg_free( msg );
+    }
+    return err;
 }
+#endif
 
 
-static tic_error_t set_payload( char *buf, size_t size, dataset_t *ds )
+#ifdef CONFIG_TIC_BATCH
+// publie le lot du format, gardé pour une nouvelle tentative si le pool de messages est vide
+static void publish_batch( const tic_data_t *data, uint8_t format, batch_flush_t cause )
 {
-    dataset_t * p_actives = puissance_get_all();
-    ds = dataset_append( ds, p_actives );
-    return datasets_to_json( buf, size, ds );
+    batch_t *b = &(s_batches[( format == PAYLOAD_CBOR ) ? BATCH_CBOR : BATCH_JSON]);
+    mqtt_msg_t *msg = mqtt_msg_alloc();
+    if( msg == NULL)
+    {
+        return;     // pool vide, erreur logguee dans mqtt_msg_alloc()
+    }
+
+    set_topic( msg->topic, MQTT_TOPIC_BUFFER_SIZE, data,
+               ( format == PAYLOAD_CBOR ) ? MQTT_TOPIC_CBOR_SUFFIX MQTT_TOPIC_BATCH_SUFFIX : MQTT_TOPIC_BATCH_SUFFIX );
+    msg->binaire = ( format == PAYLOAD_CBOR );
+    tic_error_t err = batch_finish( b, msg->payload, MQTT_PAYLOAD_BUFFER_SIZE, &(msg->payload_len), cause );
+
+    taskENTER_CRITICAL( &s_stats_spinlock );
+    if( format == PAYLOAD_CBOR )
+    {
+        s_stats.batch_cbor = b->stats;
+    }
+    else
+    {
+        s_stats.batch_json = b->stats;
+    }
+    taskEXIT_CRITICAL( &s_stats_spinlock );
+
+    if( err == TIC_OK )
+    {
+        err = mqtt_receive_msg(msg);
+    }
+    else
+    {
+        ESP_LOGE (TAG, "batch_finish() erreur %d", err);
+    }
+    if( err != TIC_OK )
+    {
+        // le lot a été vidé : ses trames delta sont perdues
+        mqtt_msg_free( msg );
+#ifdef CONFIG_TIC_PUBLISH_DELTA
+        delta_force_keyframe( &s_delta );
+#endif
+    }
 }
 
 
-static tic_error_t build_mqtt_msg( mqtt_msg_t *msg, dataset_t *ds, const tic_data_t *data )
+// ajoute la trame au lot du format, et publie le lot s'il est plein, trop ancien ou si la trame est urgente
+static tic_error_t add_to_batch( tic_frame_t *frame, const tic_data_t *data, uint8_t format, bool urgent )
 {
-    tic_error_t err;
-    err = set_topic( msg->topic, MQTT_TOPIC_BUFFER_SIZE, data );
+    batch_t *b = &(s_batches[( format == PAYLOAD_CBOR ) ? BATCH_CBOR : BATCH_JSON]);
+    size_t len;
+    tic_error_t err = set_payload( s_doc, sizeof(s_doc), frame, format, &len );
     if( err != TIC_OK )
     {
-        ESP_LOGD( TAG, "Erreur lors de la création du topic MQTT");
+        ESP_LOGE (TAG, "set_payload() erreur %d", err);
         return err;
     }
 
-    err = set_payload( msg->payload, MQTT_PAYLOAD_BUFFER_SIZE, ds );
+    int64_t now = esp_timer_get_time();
+    err = batch_add( b, s_doc, len, frame, now );
+    if( err == TIC_ERR_OVERFLOW && !batch_is_empty( b ) )
+    {
+        publish_batch( data, format, BATCH_FLUSH_SIZE );
+        err = batch_add( b, s_doc, len, frame, now );
+    }
     if( err != TIC_OK )
     {
-        ESP_LOGD( TAG, "Erreur lors de la création du payload MQTT");
+        ESP_LOGE (TAG, "trame de %u bytes perdue, lot de %u trames non publié", (unsigned)len, (unsigned)b->nb_frames );
         return err;
     }
-    return TIC_OK;
 
+    batch_flush_t cause = batch_due( b, now, urgent );
+    if( cause != BATCH_FLUSH_NONE )
+    {
+        publish_batch( data, format, cause );
+    }
+    return TIC_OK;      // la trame est dans le lot, publié plus tard si besoin
 }
+#endif
 
 
 static tic_error_t traite_donnees( const tic_data_t *data )
 {
     // mise à jour afficheur oled, etc
+    // les index d'energie sont reçus par puissance.c directement du decodeur
     send_event_tic_data (data);
 
-    // envoie la trame au module de calcul de puissance active
-    // TODO : passer par l'event loop
-    puissance_incoming_data( data );     // ignore erreurs
-
     return TIC_OK;
 }
 
@@ -203,25 +409,32 @@ static void process_task( void *pvParams )
 {
     ESP_LOGI( TAG, "process_task()");
 
-    mqtt_msg_t *msg = NULL;
-    dataset_t *ds = NULL;
+    tic_frame_t *frame = NULL;
     tic_error_t err;
-    tic_data_t data;
+    tic_data_t data = {0};
 
     for(;;)
     {
         //ESP_LOGD( TAG, "START process_task loop ds=%p msg=%p ...", ds, msg );
-        dataset_free( ds );    //libère les datasets reçus de decode_task
-        ds = NULL;
-
-        mqtt_msg_free( msg );        // libere les msg non-envoyés à mqtt_task
-        msg=NULL;
+        frame_free( frame );    // rend au pool la trame reçue de decode_task
+        frame = NULL;
 
-        BaseType_t ds_received = xQueueReceive( s_to_process, &ds, TIC_PROCESS_TIMEOUT_MS/portTICK_PERIOD_MS );
+        BaseType_t ds_received = xQueueReceive( s_to_process, &frame, TIC_PROCESS_TIMEOUT_MS/portTICK_PERIOD_MS );
         if( ds_received != pdTRUE )
         {
             send_event_tic_data ( &null_data);
             ESP_LOGD( TAG, "Aucune trame téléinfo reçue depuis %d ms", TIC_PROCESS_TIMEOUT_MS);
+#ifdef CONFIG_TIC_BATCH
+            // plus de trames : les lots en cours sont publiés sans attendre leur fin
+            if( !batch_is_empty( &(s_batches[BATCH_JSON]) ) )
+            {
+                publish_batch( &data, PAYLOAD_JSON, BATCH_FLUSH_AGE );
+            }
+            if( !batch_is_empty( &(s_batches[BATCH_CBOR]) ) )
+            {
+                publish_batch( &data, PAYLOAD_CBOR, BATCH_FLUSH_AGE );
+            }
+#endif
             continue;
         }
 
@@ -229,37 +442,96 @@ static void process_task( void *pvParams )
         //ESP_LOGD( TAG, "%"PRIu32" datasets reçus ds=%p &ds=%p", nb, ds, &ds);
 
         // extrait les données utiles et effectue les traitements 
-        err = dataset_parse( ds, &data );
+        err = dataset_parse( frame, &data );
         if( err == TIC_OK )
         {
             traite_donnees( &data ); // ignore erreurs et continue dans tous les cas
         }
 
-        msg = mqtt_msg_alloc();
-        if( msg == NULL)
+        // ajoute les puissances actives à la trame
+        puissance_get_all( frame );
+
+#ifdef CONFIG_TIC_PUBLISH_DELTA
+        // retire les etiquettes inchangées, sauf pour les trames complètes
+        taskENTER_CRITICAL( &s_stats_spinlock );
+        bool force_keyframe = s_force_keyframe;
+        s_force_keyframe = false;
+        taskEXIT_CRITICAL( &s_stats_spinlock );
+        if( force_keyframe )
         {
-            continue;   // erreur logguee dans mqtt_alloc_msg()
+            delta_force_keyframe( &s_delta );
         }
-
-        err = build_mqtt_msg (msg, ds, &data);
-        if(err != TIC_OK)
+        delta_filter( &s_delta, frame, esp_timer_get_time() );
+
+        taskENTER_CRITICAL( &s_stats_spinlock );
+        s_stats.delta_keyframes = s_delta.keyframes;
+        s_stats.delta_frames = s_delta.deltas;
+        s_stats.delta_labels_sent = s_delta.labels_sent;
+        s_stats.delta_labels_skipped = s_delta.labels_skipped;
+        taskEXIT_CRITICAL( &s_stats_spinlock );
+#endif
+
+        // trame confiée à mqtt_task ( ou à un lot ) dans tous les formats
+        bool publiee = true;
+#ifdef CONFIG_TIC_BATCH
+        // puissance apparente au dessus du seuil : publiée sans attendre la fin du lot
+        bool urgent = ( CONFIG_TIC_BATCH_URGENT_VA > 0 && err == TIC_OK && data.puissance_app >= CONFIG_TIC_BATCH_URGENT_VA );
+        if( s_payload_formats & PAYLOAD_JSON )
         {
-            ESP_LOGE (TAG, "build_mqtt_msg() erreur %d", err);
-            continue;
+            publiee = ( add_to_batch( frame, &data, PAYLOAD_JSON, urgent ) == TIC_OK ) && publiee;
+        }
+        if( s_payload_formats & PAYLOAD_CBOR )
+        {
+            publiee = ( add_to_batch( frame, &data, PAYLOAD_CBOR, urgent ) == TIC_OK ) && publiee;
+        }
+#elif defined(CONFIG_TIC_TOPIC_PER_LABEL)
+        // un message retenu par etiquette modifiée, quel que soit le format des payloads
+        publiee = ( publish_labels( frame, &data ) == TIC_OK );
+#else
+        if( s_payload_formats & PAYLOAD_JSON )
+        {
+            publiee = ( publish( frame, &data, PAYLOAD_JSON ) == TIC_OK ) && publiee;
         }
+        if( s_payload_formats & PAYLOAD_CBOR )
+        {
+            publiee = ( publish( frame, &data, PAYLOAD_CBOR ) == TIC_OK ) && publiee;
+        }
+#endif
 
-        // envoie le message à mqtt_task
-        if( mqtt_receive_msg(msg) == TIC_OK )
+#ifdef CONFIG_TIC_PUBLISH_DELTA
+        // trame perdue : les signatures précédentes restent la référence de la trame suivante
+        if( publiee )
         {
-            msg = NULL;   // sera liberé par mqtt_task;
+            delta_commit( &s_delta );
         }
+#else
+        (void)publiee;
+#endif
     }
     ESP_LOGE( TAG, "fatal: process_task exited" );
     vTaskDelete(NULL);
 }
 
 
-tic_error_t process_receive_datasets( dataset_t *ds )
+void process_force_keyframe( void )
+{
+#ifdef CONFIG_TIC_PUBLISH_DELTA
+    taskENTER_CRITICAL( &s_stats_spinlock );
+    s_force_keyframe = true;
+    taskEXIT_CRITICAL( &s_stats_spinlock );
+#endif
+}
+
+
+void process_get_stats( process_stats_t *stats )
+{
+    taskENTER_CRITICAL( &s_stats_spinlock );
+    *stats = s_stats;
+    taskEXIT_CRITICAL( &s_stats_spinlock );
+}
+
+
+tic_error_t process_receive_frame( tic_frame_t *frame )
 {
     if( s_to_process == NULL )
     {
@@ -267,7 +539,7 @@ tic_error_t process_receive_datasets( dataset_t *ds )
         return TIC_ERR;
     }
 
-    BaseType_t send_ok = xQueueSend( s_to_process, &ds, 10 );
+    BaseType_t send_ok = xQueueSend( s_to_process, &frame, 10 );
     if( send_ok != pdTRUE )
     {
         ESP_LOGE( TAG, "Queue pleine : impossible de recevoir la trame TIC decodee" );
@@ -281,15 +553,49 @@ tic_error_t process_receive_datasets( dataset_t *ds )
 
 tic_error_t process_task_start( QueueHandle_t to_decoder, QueueHandle_t to_mqtt )
 {
-    puissance_init();
-
     // reçoit les trames décodées par decode_task
-    s_to_process = xQueueCreate( 5, sizeof( dataset_t * ) );
+    // toutes les trames du pool peuvent être en attente, la queue ne déborde jamais
+    s_to_process = xQueueCreate( TIC_FRAME_POOL_SIZE, sizeof( tic_frame_t * ) );
     if( s_to_process==NULL )
     {
         ESP_LOGE( TAG, "xCreateQueue() failed" );
         return TIC_ERR_APP_INIT;
     }
+    if( mqtt_msg_pool_init() != TIC_OK )
+    {
+        return TIC_ERR_APP_INIT;
+    }
+    json_template_init( &s_template );
+
+    // format des payloads : NVS, sinon Kconfig
+#if defined(CONFIG_TIC_PAYLOAD_CBOR)
+    uint8_t format = 1;
+#elif defined(CONFIG_TIC_PAYLOAD_JSON_CBOR)
+    uint8_t format = 2;
+#else
+    uint8_t format = 0;
+#endif
+    console_nvs_get_u8( TIC_NVS_PAYLOAD_FORMAT, &format );     // clé absente : format inchangé
+    static const uint8_t FORMATS[] = { PAYLOAD_JSON, PAYLOAD_CBOR, PAYLOAD_JSON | PAYLOAD_CBOR };
+    if( format >= sizeof(FORMATS) )
+    {
+        ESP_LOGW( TAG, "%s=%d invalide, payloads JSON", TIC_NVS_PAYLOAD_FORMAT, format );
+        format = 0;
+    }
+    s_payload_formats = FORMATS[format];
+
+#ifdef CONFIG_TIC_PUBLISH_DELTA
+    delta_init( &s_delta, CONFIG_TIC_DELTA_KEYFRAME_S );
+#endif
+#ifdef CONFIG_TIC_BATCH
+#ifdef CONFIG_TIC_BATCH_AGGREGATES
+    bool aggregates = true;
+#else
+    bool aggregates = false;
+#endif
+    batch_init( &(s_batches[BATCH_JSON]), BATCH_JSON, CONFIG_TIC_BATCH_MAX_FRAMES, CONFIG_TIC_BATCH_MAX_AGE_S, aggregates );
+    batch_init( &(s_batches[BATCH_CBOR]), BATCH_CBOR, CONFIG_TIC_BATCH_MAX_FRAMES, CONFIG_TIC_BATCH_MAX_AGE_S, aggregates );
+#endif
 
     // create mqtt client task
     BaseType_t task_created = xTaskCreate( process_task, "process_task", 4096, NULL, 12, NULL);
@@ -1,56 +1,55 @@
 
 
 #include <string.h>
-#include <time.h>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
 #include "esp_log.h"
 
 #include "tic_types.h"
 #include "dataset.h"
+#include "labels.h"
+#include "decode.h"
+#include "energie.h"
 #include "puissance.h"
 
 static const char *TAG = "puissance.c";
 
-#define TIC_LAST_POINTS_CNT  10
-
-static const char *LABEL_PACT_PREFIX = "PACT";
+// conserve les derniers points reçus
+// écrit par tic_decode_task ( callbacks du decodeur ), lu par process_task
+static east_ring_t s_east_rb;
+static portMUX_TYPE s_east_spinlock = portMUX_INITIALIZER_UNLOCKED;
 
+// réception de STX de la trame en cours, mesurée par uart_rcv_task
+static int64_t s_frame_us;
 
-typedef struct point_east_s {
-    time_t ts;      // timestamp du point
-    int32_t east;                       // index d'energie active soutiree totale du compteur
-} east_point_t;
 
+static void puissance_frame_start( tic_mode_t mode, int64_t stx_us, void *ctx );
+static void puissance_line( const tic_line_t *line, void *ctx );
 
-// conserve les derniers points reçus
-static east_point_t s_east_rb[TIC_LAST_POINTS_CNT];    // ring buffer
-static int8_t s_east_current;
+static const tic_decoder_handler_t s_handler = {
+    .frame_start = puissance_frame_start,
+    .line = puissance_line,
+    .frame_end = NULL,
+    .ctx = NULL
+};
 
 
-void puissance_init()
+// à appeler avant tic_decode_task_start() : les index sont reçus directement du decodeur
+tic_error_t puissance_init()
 {
-    memset( &s_east_rb, 0, TIC_LAST_POINTS_CNT*sizeof(east_point_t));
-    s_east_current = 0;
-}
-
-// recupere un point dans le ring buffer
-// i=0 : le plus récent   
-//i=cnt : le plus ancien
-static const east_point_t* get_east_point( int8_t i )
-{
-    int8_t idx = ( i + s_east_current ) % TIC_LAST_POINTS_CNT;
-    return &(s_east_rb[idx]);
+    east_ring_init( &s_east_rb );
+    return decode_set_handler( &s_handler );
 }
 
 // ajoute un nouveau point dans le ring buffer
 static void add_east_point( const east_point_t * pt )
 {
-    // -1 pour stocker les points dans l'ordre inversé
-    int8_t pos = (s_east_current + TIC_LAST_POINTS_CNT - 1) % TIC_LAST_POINTS_CNT;
-    ESP_LOGD( TAG, "add_east_point() s_east_current=%"PRIi8" pos=%"PRIi8" ts=%"PRIi64" east=%"PRIi32, s_east_current, pos, pt->ts, pt->east );
-    s_east_rb[pos].east = pt->east;
-    s_east_rb[pos].ts = pt->ts;
-    s_east_current = pos;
+    ESP_LOGD( TAG, "add_east_point() us=%"PRIi64" east=%"PRIi32, pt->us, pt->east );
+    taskENTER_CRITICAL( &s_east_spinlock );
+    east_ring_add( &s_east_rb, pt );
+    taskEXIT_CRITICAL( &s_east_spinlock );
 }
 
 
@@ -62,38 +61,27 @@ int32_t puissance_get ( uint8_t n )
         return -1;
     }
 
-    const east_point_t *p0 = get_east_point( 0 );
-    const east_point_t *pN = get_east_point( n );
-
-    if( pN->east==0 || pN->ts==0 || p0->east==0 || p0->ts==0 )
-    {
-        //ESP_LOGD( TAG, "p_active(%d) indisponible", n);
-        return -1;
-    }
-
-    int32_t energie = pN->east - p0->east;
-    time_t duree = pN->ts - p0->ts;
+    // copie des deux points : le ring buffer est modifié par tic_decode_task
+    taskENTER_CRITICAL( &s_east_spinlock );
+    east_point_t p0 = *east_ring_get( &s_east_rb, 0 );
+    east_point_t pN = *east_ring_get( &s_east_rb, n );
+    taskEXIT_CRITICAL( &s_east_spinlock );
 
-    if( duree == 0 )
-    {
-        ESP_LOGD( TAG, "p_active(%d) indisponible : deux index avec horodate identique", n);
-        return -1;
-    }
-
-    return (3600*energie)/duree;    // energie est en Watt.heure, on veut des Watt.seconde
+    return east_puissance( &p0, &pN );
 }
 
-// calcule les puissances actives et revoie les resultats sous forme de datasets 
-dataset_t * puissance_get_all()
+// calcule les puissances actives et ajoute les resultats à la trame sous forme de datasets 
+void puissance_get_all( tic_frame_t *frame )
 {
-    dataset_t * ret = NULL;
-
     // pour le debug
     char etat[TIC_LAST_POINTS_CNT+2];
     etat[0] = '[';
     etat[TIC_LAST_POINTS_CNT] = ']';
     etat[TIC_LAST_POINTS_CNT+1] = '\0';
 
+    char etiquette[TIC_SIZE_ETIQUETTE];
+    char valeur[12];
+
     for( uint8_t i=1; i<TIC_LAST_POINTS_CNT; i++ )
     {
         int32_t p = puissance_get( i );
@@ -105,33 +93,59 @@ dataset_t * puissance_get_all()
         }
         etat[i] = 'x';
         
-        dataset_t *ds = dataset_alloc();
-        snprintf( ds->etiquette, TIC_SIZE_ETIQUETTE, "%s%02"PRIi8, LABEL_PACT_PREFIX, i );
-        snprintf( ds->valeur, TIC_SIZE_VALUE, "%"PRIi32, p );
-        ds->flags = TIC_DS_NUMERIQUE | TIC_DS_PUBLISHED;
-
-        ret = dataset_append( ret, ds );
+        int etiquette_len = snprintf( etiquette, sizeof(etiquette), "PACT%02"PRIi8, i );
+        int valeur_len = snprintf( valeur, sizeof(valeur), "%"PRIi32, p );
+        dataset_t *ds = dataset_new( frame, TIC_LABEL_PACT01 + i - 1, etiquette, etiquette_len, NULL, 0, valeur, valeur_len );
+        if( ds == NULL )
+        {
+            break;      // erreur logguée par dataset_new()
+        }
+        label_flags( ds->label, TIC_MODE_INCONNU, &(ds->flags) );
+        dataset_insert( frame, ds );
     }
     ESP_LOGD(TAG, "Puissances actives disponibles %s", etat);
-    return ret;
 }
 
 
-tic_error_t puissance_incoming_data( const tic_data_t *data )
+static void puissance_frame_start( tic_mode_t mode, int64_t stx_us, void *ctx )
 {
-    east_point_t pt = {
-        .ts = data->horodate,
-        .east = data->index_energie
-    };
-
-    // compare avec le dernier point reçu 
-    const east_point_t *prev = get_east_point( 0 );
-    if( prev->east != pt.east )
+    s_frame_us = stx_us;
+}
+
+
+// appelé par tic_decode_task dès le CR de chaque ligne valide
+static void puissance_line( const tic_line_t *line, void *ctx )
+{
+    switch( line->label )
     {
-        add_east_point( &pt );  // ne renvoie jamais d'erreur
-        ESP_LOGD( TAG, "nouvel index energie reçu %"PRIi32, pt.east );
+        case TIC_LABEL_BASE:
+        case TIC_LABEL_EAST:
+        {
+            tic_value_t val;
+            if( label_parse_value( line->label, line->valeur, line->valeur_len, &val ) != TIC_OK )
+            {
+                ESP_LOGE( TAG, "index d'energie invalide '%s'", line->valeur );
+                break;
+            }
+
+            // trame sans heure de STX ( perdue par uart_rcv_task ) : heure de la ligne
+            east_point_t pt = {
+                .us = s_frame_us ? s_frame_us : esp_timer_get_time(),
+                .east = val.entier
+            };
+
+            // compare avec le dernier point reçu ( seul tic_decode_task écrit le ring buffer )
+            if( east_ring_get( &s_east_rb, 0 )->east != pt.east )
+            {
+                add_east_point( &pt );
+                ESP_LOGD( TAG, "nouvel index energie reçu %"PRIi32, pt.east );
+            }
+            break;
+        }
+
+        default:
+            break;
     }
-    return TIC_OK;
 }
 
 
@@ -0,0 +1,331 @@
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+#include "tic_types.h"
+#include "tic_config.h"
+#include "nvs_utils.h"
+#include "spool.h"
+
+static const char *TAG = "spool.c";
+
+#define SPOOL_SECTOR     4096       // unité d'effacement de la flash
+#define SPOOL_MAGIC      0x5354
+#define SPOOL_BINAIRE    0x01       // mqtt_msg_t.binaire
+#define SPOOL_PAR_ETIQUETTE 0x02    // mqtt_msg_t.par_etiquette
+
+// entête d'un enregistrement, suivi du topic et du payload puis complété à un multiple de 4
+typedef struct {
+    uint16_t magic;
+    uint16_t payload_len;
+    uint8_t topic_len;
+    uint8_t flags;
+    uint16_t reserved;
+    uint32_t seq;               // numéro du message, consécutifs dans le spool
+    uint32_t crc;               // crc32 du topic et du payload
+} spool_header_t;
+
+// position de lecture sauvegardée en NVS
+typedef struct {
+    uint32_t pos;
+    uint32_t seq;
+} spool_pos_t;
+
+static const esp_partition_t *s_part = NULL;
+
+// messages en attente : seq de rd_seq à wr_seq exclu
+static uint32_t s_rd;
+static uint32_t s_rd_seq;
+static uint32_t s_wr;
+static uint32_t s_wr_seq;
+static spool_pos_t s_committed;
+
+// taille de l'enregistrement lu par spool_peek()
+static uint32_t s_peek_size = 0;
+
+// enregistrement en cours d'écriture ou de lecture
+static uint8_t s_rec[sizeof(spool_header_t) + MQTT_TOPIC_BUFFER_SIZE + MQTT_PAYLOAD_BUFFER_SIZE];
+
+static spool_stats_t s_stats = {0};
+static portMUX_TYPE s_stats_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+
+static uint32_t record_size( const spool_header_t *hdr )
+{
+    return ( sizeof(*hdr) + hdr->topic_len + hdr->payload_len + 3 ) & ~3UL;
+}
+
+
+static uint32_t next_sector( uint32_t pos )
+{
+    pos = ( pos / SPOOL_SECTOR + 1 ) * SPOOL_SECTOR;
+    return ( pos >= s_part->size ) ? 0 : pos;
+}
+
+
+static void count( uint32_t *counter, uint32_t n )
+{
+    taskENTER_CRITICAL( &s_stats_spinlock );
+    *counter += n;
+    s_stats.pending = s_wr_seq - s_rd_seq;
+    taskEXIT_CRITICAL( &s_stats_spinlock );
+}
+
+
+// entête du message seq à pos, ou au début du secteur suivant s'il n'y avait plus de place à pos
+// pos est mis à jour avec la position de l'enregistrement trouvé
+static bool find_header( uint32_t *pos, uint32_t seq, spool_header_t *hdr )
+{
+    uint32_t candidates[2] = { *pos, next_sector( *pos ) };
+    for( int i = 0; i < 2; i++ )
+    {
+        uint32_t p = candidates[i];
+        if( SPOOL_SECTOR - ( p % SPOOL_SECTOR ) < sizeof(*hdr) )
+        {
+            continue;
+        }
+        if( esp_partition_read( s_part, p, hdr, sizeof(*hdr) ) != ESP_OK )
+        {
+            return false;
+        }
+        if(    hdr->magic == SPOOL_MAGIC && hdr->seq == seq
+            && ( p % SPOOL_SECTOR ) + record_size( hdr ) <= SPOOL_SECTOR )
+        {
+            *pos = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// lit et vérifie le topic et le payload de l'enregistrement dans s_rec
+static bool read_body( uint32_t pos, const spool_header_t *hdr )
+{
+    size_t len = hdr->topic_len + hdr->payload_len;
+    if(    hdr->topic_len >= MQTT_TOPIC_BUFFER_SIZE || hdr->payload_len > MQTT_PAYLOAD_BUFFER_SIZE
+        || esp_partition_read( s_part, pos + sizeof(*hdr), s_rec, len ) != ESP_OK )
+    {
+        return false;
+    }
+    return esp_rom_crc32_le( 0, s_rec, len ) == hdr->crc;
+}
+
+
+tic_error_t spool_init()
+{
+    s_part = esp_partition_find_first( ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, TIC_SPOOL_PARTITION );
+    if( s_part == NULL )
+    {
+        ESP_LOGE( TAG, "partition '%s' absente, voir partitions_custom.csv", TIC_SPOOL_PARTITION );
+        return TIC_ERR_APP_INIT;
+    }
+
+    // position de lecture sauvegardée, 0 au 1er démarrage
+    spool_pos_t saved = {0};
+    if( console_nvs_get_blob_fixed( TIC_NVS_SPOOL_POS, &saved, sizeof(saved) ) != TIC_OK || saved.pos >= s_part->size )
+    {
+        saved.pos = 0;
+        saved.seq = 0;
+    }
+    s_committed = saved;
+    s_rd = saved.pos;
+    s_rd_seq = saved.seq;
+
+    // les messages consécutifs qui suivent sont en attente
+    uint32_t pos = saved.pos;
+    uint32_t seq = saved.seq;
+    spool_header_t hdr;
+    while( seq - saved.seq < s_part->size / sizeof(hdr) && find_header( &pos, seq, &hdr ) && read_body( pos, &hdr ) )
+    {
+        pos += record_size( &hdr );
+        seq++;
+    }
+    // la fin du secteur courant a peut-être été abimée par une coupure pendant une écriture
+    s_wr = ( pos % SPOOL_SECTOR == 0 ) ? pos : next_sector( pos );
+    s_wr = ( s_wr >= s_part->size ) ? 0 : s_wr;
+    s_wr_seq = seq;
+
+    s_stats.size = s_part->size;
+    s_stats.pending = s_wr_seq - s_rd_seq;
+    ESP_LOGI( TAG, "spool de %"PRIu32" Ko : %"PRIu32" messages en attente", s_part->size / 1024, s_wr_seq - s_rd_seq );
+    return TIC_OK;
+}
+
+
+bool spool_is_empty()
+{
+    return s_part == NULL || s_rd_seq == s_wr_seq;
+}
+
+
+// le secteur de s_wr va être effacé : les messages non relus qu'il contient sont perdus
+static void drop_sector()
+{
+    if( spool_is_empty() || s_rd / SPOOL_SECTOR != s_wr / SPOOL_SECTOR )
+    {
+        return;
+    }
+    uint32_t pos = next_sector( s_wr );
+    spool_header_t hdr;
+    uint32_t old_seq = s_rd_seq;
+    if(    esp_partition_read( s_part, pos, &hdr, sizeof(hdr) ) == ESP_OK
+        && hdr.magic == SPOOL_MAGIC && hdr.seq - s_rd_seq < s_wr_seq - s_rd_seq )
+    {
+        s_rd = pos;
+        s_rd_seq = hdr.seq;
+    }
+    else
+    {
+        s_rd = s_wr;
+        s_rd_seq = s_wr_seq;
+    }
+    ESP_LOGW( TAG, "spool plein : %"PRIu32" messages perdus", s_rd_seq - old_seq );
+    count( &s_stats.dropped, s_rd_seq - old_seq );
+    spool_commit();
+}
+
+
+tic_error_t spool_append( const mqtt_msg_t *msg )
+{
+    if( s_part == NULL )
+    {
+        return TIC_ERR;
+    }
+
+    spool_header_t *hdr = (spool_header_t *)s_rec;
+    size_t topic_len = strnlen( msg->topic, MQTT_TOPIC_BUFFER_SIZE - 1 );
+    size_t payload_len = msg->payload_len ? msg->payload_len : strnlen( msg->payload, MQTT_PAYLOAD_BUFFER_SIZE );
+    memset( hdr, 0xFF, sizeof(*hdr) );
+    hdr->magic = SPOOL_MAGIC;
+    hdr->topic_len = topic_len;
+    hdr->payload_len = payload_len;
+    hdr->flags = ( msg->binaire ? SPOOL_BINAIRE : 0 ) | ( msg->par_etiquette ? SPOOL_PAR_ETIQUETTE : 0 );
+    hdr->seq = s_wr_seq;
+    memcpy( &(s_rec[sizeof(*hdr)]), msg->topic, topic_len );
+    memcpy( &(s_rec[sizeof(*hdr) + topic_len]), msg->payload, payload_len );
+    hdr->crc = esp_rom_crc32_le( 0, &(s_rec[sizeof(*hdr)]), topic_len + payload_len );
+    uint32_t size = record_size( hdr );
+
+    // un enregistrement ne chevauche pas deux secteurs
+    if( ( s_wr % SPOOL_SECTOR ) + size > SPOOL_SECTOR )
+    {
+        s_wr = next_sector( s_wr );
+    }
+    if( spool_is_empty() )
+    {
+        s_rd = s_wr;
+    }
+    if( s_wr % SPOOL_SECTOR == 0 )
+    {
+        drop_sector();
+        if( esp_partition_erase_range( s_part, s_wr, SPOOL_SECTOR ) != ESP_OK )
+        {
+            ESP_LOGE( TAG, "esp_partition_erase_range(%"PRIu32") failed", s_wr );
+            count( &s_stats.errors, 1 );
+            return TIC_ERR;
+        }
+    }
+
+    if( esp_partition_write( s_part, s_wr, s_rec, size ) != ESP_OK )
+    {
+        ESP_LOGE( TAG, "esp_partition_write(%"PRIu32") failed", s_wr );
+        count( &s_stats.errors, 1 );
+        s_wr = next_sector( s_wr );     // fin du secteur inutilisable
+        return TIC_ERR;
+    }
+    s_wr += size;
+    s_wr_seq++;
+    count( &s_stats.appended, 1 );
+    return TIC_OK;
+}
+
+
+tic_error_t spool_peek( mqtt_msg_t *msg )
+{
+    while( !spool_is_empty() )
+    {
+        spool_header_t hdr;
+        if( find_header( &s_rd, s_rd_seq, &hdr ) && read_body( s_rd, &hdr ) )
+        {
+            memcpy( msg->topic, s_rec, hdr.topic_len );
+            msg->topic[hdr.topic_len] = '\0';
+            memcpy( msg->payload, &(s_rec[hdr.topic_len]), hdr.payload_len );
+            if( hdr.payload_len < MQTT_PAYLOAD_BUFFER_SIZE )
+            {
+                msg->payload[hdr.payload_len] = '\0';
+            }
+            msg->payload_len = hdr.payload_len;
+            msg->binaire = ( hdr.flags & SPOOL_BINAIRE ) != 0;
+            msg->par_etiquette = ( hdr.flags & SPOOL_PAR_ETIQUETTE ) != 0;
+            s_peek_size = record_size( &hdr );
+            return TIC_OK;
+        }
+
+        // message illisible : passe au suivant s'il a un entête valide, sinon au 1er message
+        // du secteur suivant. Si ce secteur ne contient pas la suite, le spool est abandonné
+        uint32_t old_seq = s_rd_seq;
+        if( find_header( &s_rd, s_rd_seq, &hdr ) )
+        {
+            s_rd += record_size( &hdr );
+            s_rd_seq++;
+        }
+        else
+        {
+            s_rd = next_sector( s_rd );
+            if(    esp_partition_read( s_part, s_rd, &hdr, sizeof(hdr) ) == ESP_OK
+                && hdr.magic == SPOOL_MAGIC && hdr.seq - s_rd_seq < s_wr_seq - s_rd_seq )
+            {
+                s_rd_seq = hdr.seq;
+            }
+            else
+            {
+                s_rd = s_wr;
+                s_rd_seq = s_wr_seq;
+            }
+        }
+        ESP_LOGW( TAG, "%"PRIu32" messages illisibles", s_rd_seq - old_seq );
+        count( &s_stats.errors, s_rd_seq - old_seq );
+    }
+    return TIC_ERR;
+}
+
+
+void spool_consume()
+{
+    if( spool_is_empty() || s_peek_size == 0 )
+    {
+        return;
+    }
+    s_rd += s_peek_size;
+    s_rd_seq++;
+    s_peek_size = 0;
+    count( &s_stats.replayed, 1 );
+}
+
+
+void spool_commit()
+{
+    if( s_part == NULL || ( s_committed.pos == s_rd && s_committed.seq == s_rd_seq ) )
+    {
+        return;
+    }
+    spool_pos_t pos = { s_rd, s_rd_seq };
+    if( console_nvs_set_blob( TIC_NVS_SPOOL_POS, &pos, sizeof(pos) ) != TIC_OK )
+    {
+        ESP_LOGE( TAG, "sauvegarde de la position du spool impossible" );
+        return;
+    }
+    s_committed = pos;
+}
+
+
+void spool_get_stats( spool_stats_t *stats )
+{
+    taskENTER_CRITICAL( &s_stats_spinlock );
+    *stats = s_stats;
+    taskEXIT_CRITICAL( &s_stats_spinlock );
+}
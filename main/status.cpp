@@ -20,13 +20,29 @@
 #include "tic_types.h"
 #include "event_loop.h"
 #include "uart_events.h"
+#include "decode.h"
+#include "frame_pool.h"
+#include "mqtt.h"
+#include "spool.h"
+#include "process.h"
 #include "status.h"
 
 static const char *TAG = "status.cpp";
 
 static const char *FMT_UART            = "UART rx_rate=%d tic_signal=%d\n";
 static const char *FMT_UART_NOSIGNAL   = "UART rx_rate=%d no signal\n";
+static const char *FMT_DETECT          = "UART mode lock %" PRIu32 " ms, first frame %" PRIu32 " ms (detections %" PRIu32 ", baud changes %" PRIu32 ") frame wakeups %" PRIu32 " data wakeups %" PRIu32 "\n";
+static const char *FMT_DECODE          = "UART rx_bytes=%" PRIu32 " dropped=%" PRIu32 " (%" PRIu32 " overruns) buffer max %u/%u lines dropped %" PRIu32 "\n";
+static const char *FMT_FRAMES          = "TIC  frames in use %" PRIu32 "/%" PRIu32 " (max %" PRIu32 ") lost %" PRIu32 "\n";
+static const char *FMT_MQTT_MSGS       = "MQTT messages in use %" PRIu32 "/%" PRIu32 " (max %" PRIu32 ") lost %" PRIu32 "\n";
+static const char *FMT_SPOOL           = "MQTT spool %" PRIu32 " pending (%" PRIu32 " KB), appended %" PRIu32 " replayed %" PRIu32 " dropped %" PRIu32 " errors %" PRIu32 "\n";
+static const char *FMT_QOS1            = "MQTT QoS1 in flight %" PRIu32 "/%" PRIu32 ", enqueued %" PRIu32 " acked %" PRIu32 " (last %" PRIu32 " ms max %" PRIu32 " ms) retransmits est. ~%" PRIu32 " expired %" PRIu32 " rejected %" PRIu32 " window full %" PRIu32 "\n";
+static const char *FMT_ALIAS           = "MQTT topic aliases %" PRIu32 "/%" PRIu32 ", registrations %" PRIu32 " hits %" PRIu32 " (%" PRIu32 " bytes saved)\n";
 static const char *FMT_TICMODE         = "TIC  mode %s\n";
+static const char *FMT_JSON            = "JSON %" PRIu32 " frames, cycles last %" PRIu32 " avg %" PRIu32 " max %" PRIu32 ", last payload %u bytes, template hits %" PRIu32 " rebuilds %" PRIu32 "\n";
+static const char *FMT_CBOR            = "CBOR %" PRIu32 " frames, last payload %u bytes\n";
+static const char *FMT_BATCH           = "Batch %s %" PRIu32 " messages %" PRIu32 " frames, flush size %" PRIu32 " count %" PRIu32 " age %" PRIu32 " urgent %" PRIu32 "\n";
+static const char *FMT_DELTA           = "Delta %" PRIu32 " keyframes %" PRIu32 " deltas, labels sent %" PRIu32 " skipped %" PRIu32 "\n";
 static const char *FMT_MQTT            = "MQTT %s\n";
 static const char *FMT_WIFI            = "WIFI ssid '%s' chan %d rssi %d\n";
 static const char *FMT_WIFI_NOCNX      = "WIFI not connected\n";
@@ -76,6 +92,7 @@ private:
     void print_time();
     void print_tic_mode();
     void print_uart();
+    void print_decode();
     void print_mqtt();
     void print_wifi();
     void print_ip_addr();
@@ -311,6 +328,19 @@ void TicStatus::print_uart()
     } else {
         printf( FMT_UART_NOSIGNAL, rx );
     }
+
+    uart_detect_stats_t detect;
+    uart_get_detect_stats( &detect );
+    printf( FMT_DETECT, detect.lock_ms, detect.first_frame_ms, detect.detections, detect.baud_changes,
+            detect.frame_wakeups, detect.data_wakeups );
+}
+
+void TicStatus::print_decode()
+{
+    decode_stats_t stats;
+    decode_get_stats( &stats );
+    printf( FMT_DECODE, stats.bytes_received, stats.bytes_dropped, stats.overruns,
+            (unsigned)stats.buffer_max_used, (unsigned)stats.buffer_size, stats.lines_dropped );
 }
 
 void TicStatus::print_tic_mode()
@@ -329,6 +359,50 @@ void TicStatus::print_tic_mode()
             txt = STATUS_INCONNU;
     }
     printf( FMT_TICMODE, txt );
+
+    frame_pool_stats_t stats;
+    frame_pool_get_stats( &stats );
+    printf( FMT_FRAMES, stats.in_use, stats.pool_size, stats.max_in_use, stats.alloc_failures );
+
+    mqtt_msg_pool_stats_t msgs;
+    mqtt_msg_pool_get_stats( &msgs );
+    printf( FMT_MQTT_MSGS, msgs.in_use, msgs.pool_size, msgs.max_in_use, msgs.alloc_failures );
+#ifdef CONFIG_TIC_MQTT_QOS1
+    mqtt_qos1_stats_t qos1;
+    mqtt_qos1_get_stats( &qos1 );
+    printf( FMT_QOS1, qos1.in_flight, qos1.window, qos1.enqueued, qos1.acked, qos1.ack_ms_last, qos1.ack_ms_max,
+            qos1.retransmits_est, qos1.expired, qos1.rejected, qos1.window_full );
+#endif
+#if defined(CONFIG_TIC_MQTT5_TOPIC_ALIAS_MAX) && CONFIG_TIC_MQTT5_TOPIC_ALIAS_MAX > 0
+    mqtt_alias_stats_t alias;
+    mqtt_alias_get_stats( &alias );
+    printf( FMT_ALIAS, alias.aliases, alias.alias_max, alias.registrations, alias.hits, alias.topic_bytes_saved );
+#endif
+#ifdef CONFIG_TIC_SPOOL
+    spool_stats_t spool;
+    spool_get_stats( &spool );
+    printf( FMT_SPOOL, spool.pending, spool.size / 1024, spool.appended, spool.replayed, spool.dropped, spool.errors );
+#endif
+
+    process_stats_t process;
+    process_get_stats( &process );
+    uint32_t avg = process.json_frames ? (uint32_t)( process.json_cycles_total / process.json_frames ) : 0;
+    printf( FMT_JSON, process.json_frames, process.json_cycles_last, avg, process.json_cycles_max,
+            (unsigned)process.json_bytes_last, process.json_template_hits, process.json_template_rebuilds );
+    printf( FMT_CBOR, process.cbor_frames, (unsigned)process.cbor_bytes_last );
+#ifdef CONFIG_TIC_PUBLISH_DELTA
+    printf( FMT_DELTA, process.delta_keyframes, process.delta_frames, process.delta_labels_sent, process.delta_labels_skipped );
+#endif
+#ifdef CONFIG_TIC_BATCH
+    const batch_stats_t *batches[] = { &process.batch_json, &process.batch_cbor };
+    const char *formats[] = { "JSON", "CBOR" };
+    for( int i = 0; i < 2; i++ )
+    {
+        const uint32_t *flushes = batches[i]->flushes;
+        printf( FMT_BATCH, formats[i], batches[i]->messages, batches[i]->frames, flushes[BATCH_FLUSH_SIZE],
+                flushes[BATCH_FLUSH_COUNT], flushes[BATCH_FLUSH_AGE], flushes[BATCH_FLUSH_URGENT] );
+    }
+#endif
 }
 
 void TicStatus::print_mqtt()
@@ -382,6 +456,7 @@ void TicStatus::print_status()
 //    ESP_LOGD( TAG, "TicStatus::print_status()" );
     print_time();
     print_uart();
+    print_decode();
     print_tic_mode();
     print_wifi();
     print_ip_addr();
@@ -0,0 +1,60 @@
+#include <string.h>
+
+#include "tic_types.h"
+#include "stx_clock.h"
+
+#define CHAR_STX    0x02
+
+
+void stx_clock_init( stx_clock_t *c )
+{
+    memset( c, 0, sizeof(*c) );
+}
+
+
+// heure du STX à stx_pos : les heures des STX précédents sont abandonnées,
+// celle d'un STX suivant est gardée pour lui
+static int64_t find_time( stx_clock_t *c, uint32_t stx_pos, stx_source_t source, void *ctx )
+{
+    while( c->pending || source( &(c->next), ctx ) )
+    {
+        c->pending = true;
+        int32_t ecart = (int32_t)( c->next.pos - stx_pos );
+        if( ecart < 0 )
+        {
+            c->pending = false;     // STX d'un bloc abandonné par le decodeur
+            continue;
+        }
+        if( ecart > 0 )
+        {
+            return 0;               // heure de ce STX perdue
+        }
+        c->pending = false;
+        return c->next.us;
+    }
+    return 0;
+}
+
+
+void stx_clock_chunk( stx_clock_t *c, const tic_char_t *buf, size_t len, stx_source_t source, void *ctx )
+{
+    c->nb = 0;
+    c->used = 0;
+    for( const tic_char_t *p = memchr( buf, CHAR_STX, len ); p != NULL;
+         p = memchr( p + 1, CHAR_STX, len - ( p + 1 - buf ) ) )
+    {
+        if( c->nb >= STX_CHUNK_MAX )
+        {
+            break;
+        }
+        c->us[c->nb++] = find_time( c, c->pos + ( p - buf ), source, ctx );
+    }
+    c->pos += len;
+}
+
+
+int64_t stx_clock_next( void *ctx )
+{
+    stx_clock_t *c = ctx;
+    return ( c->used < c->nb ) ? c->us[c->used++] : 0;
+}
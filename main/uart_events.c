@@ -1,17 +1,20 @@
 
 #include <string.h>
+#include <sys/param.h>      // MIN()
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/event_groups.h"
-#include "freertos/timers.h"
 #include "driver/gpio.h"
 #include "driver/uart.h"
+#include "hal/uart_ll.h"    // compteurs autobaud de l'UART
+#include "soc/soc.h"        // APB_CLK_FREQ
+#include "esp_timer.h"
 #include "esp_log.h"
 
 
 #include "tic_types.h"
 #include "tic_config.h"
 #include "uart_events.h"
+#include "mode_detect.h"
 #include "decode.h"         // pour decode_incming_bytes()
 #include "event_loop.h"     // pour status_update_baudrate()
 
@@ -21,60 +24,50 @@
 static const char *TAG = "uart_events.c";
 
 #define BUF_SIZE 512
-#define RD_BUF_SIZE (BUF_SIZE)
+
+#if CONFIG_TIC_UART_FRAME_WAKEUP
+// une trame standard complète ( ~1000 bytes ) doit tenir dans le ring buffer et être lue d'un bloc
+#define RX_RING_SIZE        4096
+#define RD_BUF_SIZE         1280
+#define PATTERN_QUEUE_SIZE  8
+#define CHAR_ETX            0x03
+// mode verrouillé : la FIFO matérielle ( 128 bytes ) n'est vidée que presque pleine ou sur ETX,
+// sans timeout de réception, pour réveiller uart_rcv_task le moins souvent possible
+#define RX_FULL_FRAME       120
+// timeout de réception pendant la detection ( en durée de symboles, valeur par défaut du driver )
+#define RX_TOUT_DETECTION   10
+#else
+#define RX_RING_SIZE        (BUF_SIZE * 2)
+#define RD_BUF_SIZE         (BUF_SIZE)
+#endif
 
 #define UART_TELEINFO_NUM  UART_NUM_1
 
 #define BAUD_RATE_MODE_HISTORIQUE      1200
 #define BAUD_RATE_MODE_STANDARD        9600
 
-// nb d'evènements FRAME_ERR ou PARITY_ERR pour changer le baudrate
+// nb d'evènements FRAME_ERR ou PARITY_ERR, une fois le mode verrouillé, pour relancer la detection
 #define MAX_ERRORS_CNT                 10
 
-// délai minimum entre deux changements de baudrate
-#define TOGGLE_TIMER_DELAY_MS          1000
-
-
-static QueueHandle_t s_uart1_queue = NULL;
-static TimerHandle_t s_toggle_timer = NULL;
-
-static EventGroupHandle_t s_toggle_event = NULL;
-#define BIT_TOGGLE_REQUEST      BIT0
-#define BIT_TOGGLE_ENABLE       BIT1
+// fronts reçus avant de faire confiance à la mesure de la durée d'un bit
+#define AUTOBAUD_MIN_EDGES             64
 
+// entre 1200 et 9600 bauds ( moyenne géométrique )
+#define AUTOBAUD_SEUIL                 3394
 
-static void enable_toggle( TimerHandle_t pxTimer )
-{
-    if(s_toggle_event)
-    {
-        xEventGroupSetBits (s_toggle_event, BIT_TOGGLE_ENABLE);
-        ESP_LOGD (TAG, "enable toggle_baudrate()");
-    }
-}
 
+static QueueHandle_t s_uart1_queue = NULL;
 
-/// @brief  change le baudrate
-/// @return true si la demande de changement est prise en compte
-///         false si la demande est ignorée
-static bool toggle_baudrate()
-{
-    if (!s_toggle_event)
-    {
-        //ESP_LOGD (TAG, "toggle_baudrate() : rejeté car s_toggle_event=%p", (void*)s_toggle_event);
-        return false;
-    }
+// buffer de lecture UART, les bytes sont ensuite copiés dans le stream buffer du decodeur
+static tic_char_t s_rx_buf[RD_BUF_SIZE];
 
-    EventBits_t bits = xEventGroupGetBits (s_toggle_event);
-    if( !(bits & BIT_TOGGLE_ENABLE) )
-    {
-     //   ESP_LOGD (TAG, "toggle_baudrate() : rejeté car not enabled");
-        return false;
-    }
+// detection du mode, uniquement utilisé par uart_rcv_task
+static mode_detect_t s_detect;
+static bool s_hint_used = false;         // mesure autobaud déjà appliquée depuis le début de la detection
+static int64_t s_detect_start_us = 0;
 
-    ESP_LOGD (TAG, "toggle_baudrate() : ok");
-    xEventGroupSetBits( s_toggle_event, BIT_TOGGLE_REQUEST );
-    return true;
-}
+static uart_detect_stats_t s_detect_stats = { 0 };
+static portMUX_TYPE s_stats_spinlock = portMUX_INITIALIZER_UNLOCKED;
 
 
 int uart_get_rx_baudrate()
@@ -90,8 +83,13 @@ int uart_get_rx_baudrate()
 }
 
 
-static int get_tic_mode()
+// mode à transmettre au decodeur : celui détecté, sinon celui du baudrate
+static tic_mode_t get_tic_mode()
 {
+    if( s_detect.mode != TIC_MODE_INCONNU )
+    {
+        return s_detect.mode;
+    }
     int baudrate = uart_get_rx_baudrate();
     if (baudrate == BAUD_RATE_MODE_STANDARD)
     {
@@ -104,87 +102,234 @@ static int get_tic_mode()
     return TIC_MODE_INCONNU;
 }
 
-static void baudrate_detection_task(void *pvParameters)
+
+void uart_get_detect_stats( uart_detect_stats_t *stats )
+{
+    taskENTER_CRITICAL( &s_stats_spinlock );
+    *stats = s_detect_stats;
+    taskEXIT_CRITICAL( &s_stats_spinlock );
+}
+
+
+static uint32_t elapsed_ms()
+{
+    return (uint32_t)( ( esp_timer_get_time() - s_detect_start_us ) / 1000 );
+}
+
+
+#if CONFIG_TIC_UART_FRAME_WAKEUP
+// seuils de la FIFO : réveil par trame une fois le mode verrouillé, par blocs de
+// TIC_UART_THRESOLD bytes pendant la detection
+static void set_frame_wakeup( bool on )
 {
-    s_toggle_event = xEventGroupCreate();
-    if( !s_toggle_event)
+    esp_err_t err = uart_set_rx_full_threshold( UART_TELEINFO_NUM, on ? RX_FULL_FRAME : TIC_UART_THRESOLD );
+    if( err == ESP_OK )
+    {
+        err = uart_set_rx_timeout( UART_TELEINFO_NUM, on ? 0 : RX_TOUT_DETECTION );     // 0 : timeout désactivé
+    }
+    if( err != ESP_OK )
     {
-        ESP_LOGE(TAG, "fatal: xEventGroupCreate() failed");
-        return;
+        ESP_LOGE( TAG, "seuils de réception erreur %#x", err );
     }
+}
+#endif
+
 
-    s_toggle_timer = xTimerCreate( "baudrate_toggle_timer", TOGGLE_TIMER_DELAY_MS/portTICK_PERIOD_MS, pdFALSE, NULL, enable_toggle);
-    if( !s_toggle_timer )
+// remet à zéro les compteurs autobaud de l'UART
+static void restart_autobaud()
+{
+    uart_dev_t *hw = UART_LL_GET_HW( UART_TELEINFO_NUM );
+    uart_ll_set_autobaud_en( hw, false );
+    uart_ll_set_autobaud_en( hw, true );
+}
+
+
+// baudrate déduit de la plus courte impulsion basse mesurée par l'UART ( 1 bit )
+// 0 si la mesure n'est pas encore fiable
+static uint32_t autobaud_hint()
+{
+    uart_dev_t *hw = UART_LL_GET_HW( UART_TELEINFO_NUM );
+    if( uart_ll_get_rxd_edge_cnt( hw ) < AUTOBAUD_MIN_EDGES )
+    {
+        return 0;
+    }
+    uint32_t pulse = uart_ll_get_low_pulse_cnt( hw );       // en cycles APB
+    if( pulse == 0 )
     {
-        ESP_LOGE(TAG, "fatal; xTimerCreate() failed");
-        return;
+        return 0;
     }
-    xTimerStart (s_toggle_timer, 10);
-    ESP_LOGD (TAG, "toggle_timer créé");
+    uint32_t mesure = APB_CLK_FREQ / pulse;
+    ESP_LOGD( TAG, "autobaud : bit de %" PRIu32 " cycles, %" PRIu32 " bauds", pulse, mesure );
+    return ( mesure > AUTOBAUD_SEUIL ) ? BAUD_RATE_MODE_STANDARD : BAUD_RATE_MODE_HISTORIQUE;
+}
 
-    esp_err_t err;
-    uint32_t cur_baudrate = 0;
-    uint32_t new_baudrate = 0;
 
-    for(;;)
+static void flush_uart()
+{
+    uart_flush_input(UART_TELEINFO_NUM);
+    xQueueReset(s_uart1_queue);
+}
+
+
+static void set_baudrate( uint32_t new_baudrate )
+{
+    ESP_LOGI (TAG, "change baudrate %d -> %" PRIu32 " après %" PRIu32 " ms",
+              uart_get_rx_baudrate(), new_baudrate, elapsed_ms() );
+    esp_err_t err = uart_set_baudrate (UART_TELEINFO_NUM, new_baudrate);
+    if (err != ESP_OK)
     {
-        ESP_LOGD (TAG, "detect_task: attente sur BIT_TOGGLE");
-        /*bits = */xEventGroupWaitBits (s_toggle_event, (BIT_TOGGLE_REQUEST | BIT_TOGGLE_ENABLE), pdTRUE, pdTRUE, portMAX_DELAY);
-        ESP_LOGD (TAG, "detect_task: TOGGLE_REQ et TOGGLE_EN were set");
+        ESP_LOGE (TAG, "uart_set_baudrate() erreur %#x", err);
+    }
+    flush_uart();
+    mode_detect_reset( &s_detect );
+    restart_autobaud();
 
-        cur_baudrate = uart_get_rx_baudrate();
+    taskENTER_CRITICAL( &s_stats_spinlock );
+    s_detect_stats.baud_changes++;
+    taskEXIT_CRITICAL( &s_stats_spinlock );
+}
 
-        switch (cur_baudrate)
-        {
-            case BAUD_RATE_MODE_HISTORIQUE:
-                new_baudrate = BAUD_RATE_MODE_STANDARD;
-                break;
-            case BAUD_RATE_MODE_STANDARD:
-                new_baudrate = BAUD_RATE_MODE_HISTORIQUE;
-                break;
-            default:
-                new_baudrate = BAUD_RATE_MODE_STANDARD;
-                ESP_LOGE( TAG, "Baud rate actuel %"PRIu32" invalide", cur_baudrate);
-        }
 
-        ESP_LOGI (TAG, "change baudrate %"PRIu32" -> %"PRIu32, cur_baudrate, new_baudrate);
-        err = uart_set_baudrate (UART_TELEINFO_NUM, new_baudrate);
-        if (err != ESP_OK)
+// baudrate suivant quand les données sont incohérentes :
+// la mesure autobaud si elle est disponible ( une fois par detection ), sinon l'autre baudrate
+static void change_baudrate()
+{
+    uint32_t cur_baudrate = uart_get_rx_baudrate();
+    uint32_t new_baudrate = ( cur_baudrate == BAUD_RATE_MODE_STANDARD ) ? BAUD_RATE_MODE_HISTORIQUE : BAUD_RATE_MODE_STANDARD;
+    uint32_t hint = s_hint_used ? 0 : autobaud_hint();
+    if( hint != 0 )
+    {
+        s_hint_used = true;
+        if( hint == cur_baudrate )
         {
-            ESP_LOGE (TAG, "uart_set_baudrate() erreur %#x", err);
+            // la durée des bits est bonne : problème de signal, pas de baudrate
+            mode_detect_reset( &s_detect );
+            restart_autobaud();
+            return;
         }
-        xTimerReset (s_toggle_timer, 10);
+        new_baudrate = hint;
     }
+    set_baudrate( new_baudrate );
 }
 
 
-static void flush_uart()
+// (re)lance la detection du mode, au demarrage ou après trop d'erreurs UART
+static void start_detection()
 {
-    uart_flush_input(UART_TELEINFO_NUM);
-    xQueueReset(s_uart1_queue);
+    mode_detect_reset( &s_detect );
+    restart_autobaud();
+    s_hint_used = false;
+    s_detect_start_us = esp_timer_get_time();
+#if CONFIG_TIC_UART_FRAME_WAKEUP
+    set_frame_wakeup( false );
+#endif
+
+    taskENTER_CRITICAL( &s_stats_spinlock );
+    s_detect_stats.mode = TIC_MODE_INCONNU;
+    s_detect_stats.lock_ms = 0;
+    s_detect_stats.first_frame_ms = 0;
+    s_detect_stats.detections++;
+    taskEXIT_CRITICAL( &s_stats_spinlock );
+}
+
+
+static void detect_result( mode_detect_result_t res )
+{
+    switch( res )
+    {
+        case MODE_DETECT_MAUVAIS_BAUDRATE:
+            change_baudrate();
+            break;
+
+        case MODE_DETECT_VERROUILLE:
+            if( s_detect_stats.mode == TIC_MODE_INCONNU )
+            {
+                uint32_t ms = elapsed_ms();
+                int baudrate = uart_get_rx_baudrate();
+                ESP_LOGI( TAG, "mode %s détecté en %" PRIu32 " ms à %d bauds",
+                          ( s_detect.mode == TIC_MODE_STANDARD ) ? "standard" : "historique", ms, baudrate );
+                if( baudrate != ( ( s_detect.mode == TIC_MODE_STANDARD ) ? BAUD_RATE_MODE_STANDARD : BAUD_RATE_MODE_HISTORIQUE ) )
+                {
+                    ESP_LOGW( TAG, "baudrate %d inhabituel pour ce mode", baudrate );
+                }
+                taskENTER_CRITICAL( &s_stats_spinlock );
+                s_detect_stats.mode = s_detect.mode;
+                s_detect_stats.lock_ms = ms;
+                taskEXIT_CRITICAL( &s_stats_spinlock );
+            }
+            // 1ère trame complète aux checksums valides : fin de la detection
+            if( s_detect.frames_ok > 0 && s_detect_stats.first_frame_ms == 0 )
+            {
+                uint32_t ms = elapsed_ms();
+                ESP_LOGI( TAG, "1ère trame valide après %" PRIu32 " ms", ms );
+                taskENTER_CRITICAL( &s_stats_spinlock );
+                s_detect_stats.first_frame_ms = ( ms > 0 ) ? ms : 1;
+                taskEXIT_CRITICAL( &s_stats_spinlock );
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+// la detection continue jusqu'à la 1ère trame valide
+static bool detection_running()
+{
+    return ( s_detect.mode == TIC_MODE_INCONNU ) || ( s_detect_stats.first_frame_ms == 0 );
+}
+
+
+// lit len bytes du ring buffer vers le decodeur, par blocs de RD_BUF_SIZE, sans allocation
+static tic_error_t read_and_decode( size_t len )
+{
+    tic_error_t err = TIC_OK;
+    size_t remaining = len;
+    while( remaining > 0 )
+    {
+        int length_read = uart_read_bytes(UART_TELEINFO_NUM, s_rx_buf, MIN(remaining, RD_BUF_SIZE), portMAX_DELAY);
+        if( length_read <= 0 )
+        {
+            break;
+        }
+        remaining -= length_read;
+        if( detection_running() )
+        {
+            detect_result( mode_detect_input( &s_detect, s_rx_buf, length_read ) );
+#if CONFIG_TIC_UART_FRAME_WAKEUP
+            if( !detection_running() )
+            {
+                // les positions de ETX enregistrées pendant la detection ne sont plus valides
+                uart_pattern_queue_reset( UART_TELEINFO_NUM, PATTERN_QUEUE_SIZE );
+                set_frame_wakeup( true );
+                ESP_LOGI( TAG, "reception par trame complète" );
+            }
+#endif
+        }
+        // bytes perdus comptabilisés par decode_incoming_bytes()
+        err = decode_incoming_bytes (s_rx_buf, length_read, get_tic_mode() );
+    }
+    return err;
 }
 
 
 static void uart_rcv_task(void *pvParameters)
 {
     uart_event_t event;
-    tic_char_t *tmpbuf = NULL;
     int uart_err_cnt = 0;
-    int length_read;
     int baudrate, uart_period;
 
-    tic_error_t err;
+    start_detection();
 
     for(;;) {
 
-        // autodetection mode standard/hstorique
-        //ESP_LOGD( TAG, "err_cnt=%d", err_cnt);
+        // trop d'erreurs avec le mode verrouillé : le compteur a changé, nouvelle detection
         if (uart_err_cnt >= MAX_ERRORS_CNT)
         {
-            if( toggle_baudrate() )
-            {
-                uart_err_cnt = 0;
-            }
+            ESP_LOGW( TAG, "%d erreurs UART, nouvelle detection du mode", uart_err_cnt );
+            uart_err_cnt = 0;
+            start_detection();
         }
 
         // baudrate avec plancher à 1200 pour éviter une division par 0
@@ -192,7 +337,14 @@ static void uart_rcv_task(void *pvParameters)
         baudrate = (baudrate > 0) ? baudrate : BAUD_RATE_MODE_HISTORIQUE;
 
         // nb de Ticks pour recevoir TIC_UART_THRESOLD bytes (8 bits + stop + parity )
-        uart_period = ( TIC_UART_THRESOLD * (8+1+1) * 1000 / portTICK_PERIOD_MS ) / baudrate;
+        int threshold = TIC_UART_THRESOLD;
+#if CONFIG_TIC_UART_FRAME_WAKEUP
+        if( !detection_running() )
+        {
+            threshold = RX_FULL_FRAME;      // sans timeout, rien avant RX_FULL_FRAME bytes ou ETX
+        }
+#endif
+        uart_period = ( threshold * (8+1+1) * 1000 / portTICK_PERIOD_MS ) / baudrate;
 
         // Attend des events UART 
         BaseType_t evt_received = xQueueReceive(s_uart1_queue, (void *)&event, 2*uart_period );
@@ -200,8 +352,12 @@ static void uart_rcv_task(void *pvParameters)
         // timeout
         if (!evt_received)
         {
-            uart_err_cnt++;
             send_event_baudrate( 0 );
+            // des fronts sans aucun byte reçu : baudrate faux
+            if( s_detect.mode == TIC_MODE_INCONNU && autobaud_hint() != 0 )
+            {
+                change_baudrate();
+            }
             continue;
         }
 
@@ -209,21 +365,26 @@ static void uart_rcv_task(void *pvParameters)
             //Event of UART receving data
             case UART_DATA:
                 ESP_LOGD(TAG, "[UART DATA]: %d bytes", event.size);
-                
-                tmpbuf = calloc(1, event.size);   //  free() par le recepteur
-                if (!tmpbuf)
+                taskENTER_CRITICAL( &s_stats_spinlock );
+                s_detect_stats.data_wakeups++;
+                taskEXIT_CRITICAL( &s_stats_spinlock );
+
+#if CONFIG_TIC_UART_FRAME_WAKEUP
+                // mode verrouillé : les bytes restent dans le ring buffer jusqu'à ETX,
+                // sauf s'il se remplit sans ETX ( trame trop longue ou signal perdu )
+                if( !detection_running() )
                 {
-                    ESP_LOGE (TAG, "calloc() failed");
-                    continue;
+                    size_t buffered = 0;
+                    uart_get_buffered_data_len( UART_TELEINFO_NUM, &buffered );
+                    if( buffered < RX_RING_SIZE / 2 )
+                    {
+                        break;
+                    }
+                    event.size = buffered;
                 }
-
-                length_read = uart_read_bytes(UART_TELEINFO_NUM, tmpbuf, event.size, portMAX_DELAY);
-                err = decode_incoming_bytes (tmpbuf, length_read, get_tic_mode() );
-                if( err != TIC_OK )
+#endif
+                if( read_and_decode( event.size ) != TIC_OK )
                 {
-                    ESP_LOGE( TAG, "%d bytes perdus", length_read);
-                    free(tmpbuf);
-                    tmpbuf=NULL;
                     continue;
                 }
 
@@ -232,12 +393,38 @@ static void uart_rcv_task(void *pvParameters)
                 {
                     uart_err_cnt--;
                 }
-                else
+                else if( s_detect.mode != TIC_MODE_INCONNU )
                 {   
                     // met a jour le statut s'il n'y a plus d'erreurs
                     send_event_baudrate ( uart_get_rx_baudrate() );
                 }
                 break;
+#if CONFIG_TIC_UART_FRAME_WAKEUP
+            // ETX reçu : la trame complète est lue et decodée en une seule fois
+            case UART_PATTERN_DET:
+            {
+                int pos = uart_pattern_pop_pos( UART_TELEINFO_NUM );
+                if( detection_running() )
+                {
+                    break;      // bytes lus par UART_DATA
+                }
+                if( pos < 0 )
+                {
+                    // queue des positions pleine : le ring buffer est lu jusqu'au prochain ETX
+                    ESP_LOGW( TAG, "position de ETX perdue" );
+                    uart_pattern_queue_reset( UART_TELEINFO_NUM, PATTERN_QUEUE_SIZE );
+                    size_t buffered = 0;
+                    uart_get_buffered_data_len( UART_TELEINFO_NUM, &buffered );
+                    read_and_decode( buffered );
+                    break;
+                }
+                taskENTER_CRITICAL( &s_stats_spinlock );
+                s_detect_stats.frame_wakeups++;
+                taskEXIT_CRITICAL( &s_stats_spinlock );
+                read_and_decode( pos + 1 );
+                break;
+            }
+#endif
             //Event of HW FIFO overflow detected
             case UART_FIFO_OVF:
                 ESP_LOGE(TAG, "hw fifo overflow");
@@ -254,19 +441,21 @@ static void uart_rcv_task(void *pvParameters)
                 flush_uart();
                 break;
             //Event of UART RX break detected
-            case UART_BREAK:
-                ESP_LOGI(TAG, "uart rx break");   
-                uart_err_cnt++;                        // la teleinfo n'envoie pas de BREAK donc c'est une erreur
-                break;
             //Event of UART parity check error
-            case UART_PARITY_ERR:
-                ESP_LOGI(TAG, "uart parity error");
-                uart_err_cnt++;
-                break;
             //Event of UART frame error
+            case UART_BREAK:                        // la teleinfo n'envoie pas de BREAK donc c'est une erreur
+            case UART_PARITY_ERR:
             case UART_FRAME_ERR:
-                ESP_LOGI(TAG, "uart frame error");
-                uart_err_cnt++;
+                ESP_LOGI(TAG, "uart %s", (event.type == UART_BREAK) ? "rx break" :
+                                         (event.type == UART_PARITY_ERR) ? "parity error" : "frame error" );
+                if( s_detect.mode == TIC_MODE_INCONNU )
+                {
+                    detect_result( mode_detect_uart_error( &s_detect ) );
+                }
+                else
+                {
+                    uart_err_cnt++;
+                }
                 break;
             //Others
             default:
@@ -288,7 +477,7 @@ tic_error_t uart_task_start( )
     //Install UART driver, and get the queue.
     ESP_LOGD( TAG, "uart_driver_install()" );
 
-    err = uart_driver_install(UART_TELEINFO_NUM, BUF_SIZE * 2, BUF_SIZE * 2, 20, &s_uart1_queue, 0);
+    err = uart_driver_install(UART_TELEINFO_NUM, RX_RING_SIZE, BUF_SIZE * 2, 20, &s_uart1_queue, 0);
     if( err != ESP_OK || s_uart1_queue == NULL )
     {
         ESP_LOGE (TAG, "uart_driver_install() erreur %d", err);
@@ -296,7 +485,7 @@ tic_error_t uart_task_start( )
     }
 
     uart_config_t cfg = {
-        .baud_rate = BAUD_RATE_MODE_STANDARD,      // baudrate modifié par mode_detect_task plus tard
+        .baud_rate = BAUD_RATE_MODE_STANDARD,      // baudrate modifié par la detection du mode dans uart_rcv_task
         .data_bits = UART_DATA_7_BITS,
         .parity = UART_PARITY_EVEN,
         .stop_bits = UART_STOP_BITS_1,
@@ -323,8 +512,21 @@ tic_error_t uart_task_start( )
         return TIC_ERR_APP_INIT;
     }
 
-    if(    (xTaskCreate(uart_rcv_task, "uart_rcv_task", 4096, NULL, 12, NULL) != pdTRUE) 
-        || (xTaskCreate(baudrate_detection_task, "baudrate_detection_task", 4096, NULL, 2, NULL) != pdTRUE ) )
+#if CONFIG_TIC_UART_FRAME_WAKEUP
+    // interruption à chaque ETX, la position dans le ring buffer est conservée dans une queue
+    err = uart_enable_pattern_det_baud_intr(UART_TELEINFO_NUM, CHAR_ETX, 1, 9, 0, 0);
+    if( err == ESP_OK )
+    {
+        err = uart_pattern_queue_reset(UART_TELEINFO_NUM, PATTERN_QUEUE_SIZE);
+    }
+    if( err != ESP_OK  )
+    {
+        ESP_LOGE (TAG, "detection de ETX erreur %d", err);
+        return TIC_ERR_APP_INIT;
+    }
+#endif
+
+    if( xTaskCreate(uart_rcv_task, "uart_rcv_task", 4096, NULL, 12, NULL) != pdTRUE )
     {
         ESP_LOGE( TAG, "xTaskCreate() failed" );
         return TIC_ERR_APP_INIT;
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""
+Genere des captures TIC ( flux brut STX ... ETX ) pour le benchmark de host/
+
+Les trames reprennent le contenu d'un compteur linky monophasé en mode standard
+et d'un compteur en mode historique option base. Les index, la puissance et la date
+changent à chaque trame, les checksums sont calculés comme par le compteur.
+
+Usage : python3 tools/gen_frames.py standard|historique NB_TRAMES > capture.tic
+"""
+import sys
+
+STX = '\x02'
+ETX = '\x03'
+
+
+def checksum(data):
+    return chr((sum(data.encode('ascii')) & 0x3F) + 0x20)
+
+
+# mode standard : separateur TAB, le dernier separateur est compris dans le checksum
+def line_standard(etiquette, valeur, horodate=None):
+    data = etiquette + '\t' + (horodate + '\t' if horodate else '') + valeur + '\t'
+    return '\n' + data + checksum(data) + '\r'
+
+
+# mode historique : separateur SPACE, le dernier separateur n'est pas compris dans le checksum
+def line_historique(etiquette, valeur):
+    data = etiquette + ' ' + valeur
+    return '\n' + data + ' ' + checksum(data) + '\r'
+
+
+STANDARD = [
+    ('ADSC', '041876097521'), ('VTIC', '02'), ('DATE', '', 'E240311164715'),
+    ('NGTF', '      TEMPO     '), ('LTARF', '    HP  BLEU    '), ('EAST', '021948173'),
+    ('EASF01', '010876932'), ('EASF02', '011071241'), ('EASF03', '000000000'), ('EASF04', '000000000'),
+    ('EASF05', '000000000'), ('EASF06', '000000000'), ('EASF07', '000000000'), ('EASF08', '000000000'),
+    ('EASF09', '000000000'), ('EASF10', '000000000'),
+    ('EASD01', '010876932'), ('EASD02', '011071241'), ('EASD03', '000000000'), ('EASD04', '000000000'),
+    ('IRMS1', '004'), ('URMS1', '236'), ('PREF', '09'), ('PCOUP', '09'), ('SINSTS', '00988'),
+    ('SMAXSN', '02750', 'E240311082539'), ('SMAXSN-1', '03120', 'E240310193520'),
+    ('CCASN', '00856', 'E240311163000'), ('CCASN-1', '00912', 'E240311160000'),
+    ('UMOY1', '235', 'E240311164000'), ('STGE', '013A4401'),
+    ('MSG1', 'PAS DE          MESSAGE         '), ('PRM', '09384576218734'), ('RELAIS', '000'),
+    ('NTARF', '02'), ('NJOURF', '00'), ('NJOURF+1', '00'),
+    ('PJOURF+1', '00008001 NONUTILE NONUTILE NONUTILE NONUTILE NONUTILE NONUTILE NONUTILE NONUTILE NONUTILE NONUTILE'),
+]
+
+HISTORIQUE = [
+    ('ADCO', '031762120833'), ('OPTARIF', 'BASE'), ('ISOUSC', '30'), ('BASE', '011184735'),
+    ('PTEC', 'TH..'), ('IINST', '004'), ('IMAX', '090'), ('PAPP', '00950'), ('MOTDETAT', '000000'),
+]
+
+
+def frame_standard(i):
+    out = STX
+    for d in STANDARD:
+        etiquette, valeur = d[0], d[1]
+        horodate = d[2] if len(d) > 2 else None
+        if etiquette == 'EAST':
+            valeur = '%09d' % (21948173 + i)
+        elif etiquette == 'SINSTS':
+            valeur = '%05d' % (900 + i % 200)
+        elif etiquette == 'DATE':
+            horodate = 'E2403111647%02d' % (i % 60)
+        out += line_standard(etiquette, valeur, horodate)
+    return out + ETX
+
+
+def frame_historique(i):
+    out = STX
+    for etiquette, valeur in HISTORIQUE:
+        if etiquette == 'BASE':
+            valeur = '%09d' % (11184735 + i)
+        elif etiquette == 'PAPP':
+            valeur = '%05d' % (900 + i % 200)
+        out += line_historique(etiquette, valeur)
+    return out + ETX
+
+
+def main():
+    if len(sys.argv) != 3 or sys.argv[1] not in ('standard', 'historique'):
+        sys.exit(__doc__)
+    frame = frame_standard if sys.argv[1] == 'standard' else frame_historique
+    sys.stdout.write(''.join(frame(i) for i in range(int(sys.argv[2]))))
+
+
+if __name__ == '__main__':
+    main()
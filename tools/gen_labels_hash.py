@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""
+Genere main/include/tic_labels_hash.h a partir de la table TIC_LABELS de tic_labels.h
+
+Cherche une graine pour laquelle la fonction de hash de labels.c ne produit
+aucune collision entre les etiquettes connues ( hash parfait ).
+
+Usage : python3 tools/gen_labels_hash.py
+"""
+import os
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+SRC = os.path.join(ROOT, 'main', 'include', 'tic_labels.h')
+DST = os.path.join(ROOT, 'main', 'include', 'tic_labels_hash.h')
+
+# doit rester identique à label_hash() dans labels.c
+HASH_MULT = 31
+HASH_BITS = 8           # table de 256 entrées
+
+
+def label_hash(seed, label):
+    h = seed
+    for c in label.encode('ascii'):
+        h = (h * HASH_MULT + c) & 0xFFFFFFFF
+    return (h ^ (h >> 16)) & ((1 << HASH_BITS) - 1)
+
+
+def read_labels():
+    table = re.findall(r'X\(\s*(\w+)\s*,\s*"([^"]+)"\s*,\s*(\d+)', open(SRC).read())
+    labels = [(ident, name) for ident, name, _ in table]
+    wires = [int(wire) for _, _, wire in table]
+    names = [name for _, name in labels]
+    if names != sorted(names, key=lambda n: n.encode('ascii')):
+        sys.exit('tic_labels.h : les etiquettes doivent etre triees par ordre alphabetique')
+    if len(set(names)) != len(names):
+        sys.exit('tic_labels.h : etiquette en double')
+    if len(set(wires)) != len(wires) or max(wires) >= 0xFFFF:
+        sys.exit('tic_labels.h : identifiant wire en double ou invalide')
+    if len(names) >= 0xFF or len(names) > (1 << HASH_BITS):
+        sys.exit('tic_labels.h : trop d\'etiquettes')
+    return labels
+
+
+def find_seed(names):
+    for seed in range(1, 1 << 20):
+        slots = [label_hash(seed, n) for n in names]
+        if len(set(slots)) == len(slots):
+            return seed, slots
+    sys.exit('aucune graine sans collision, augmenter HASH_BITS')
+
+
+def main():
+    labels = read_labels()
+    names = [name for _, name in labels]
+    seed, slots = find_seed(names)
+
+    table = ['TIC_LABEL_INCONNU'] * (1 << HASH_BITS)
+    for (ident, _), slot in zip(labels, slots):
+        table[slot] = 'TIC_LABEL_' + ident
+
+    with open(DST, 'w') as f:
+        f.write('// Fichier généré par tools/gen_labels_hash.py - ne pas modifier\n')
+        f.write('#pragma once\n\n')
+        f.write('#include <stdint.h>\n')
+        f.write('#include "tic_labels.h"\n\n')
+        f.write('#define TIC_LABEL_HASH_SEED  %#x\n' % seed)
+        f.write('#define TIC_LABEL_HASH_MULT  %d\n' % HASH_MULT)
+        f.write('#define TIC_LABEL_HASH_BITS  %d\n' % HASH_BITS)
+        f.write('#define TIC_LABEL_HASH_SIZE  (1 << TIC_LABEL_HASH_BITS)\n\n')
+        f.write('// %d etiquettes\n' % len(labels))
+        f.write('static const uint8_t TIC_LABEL_HASH_TABLE[TIC_LABEL_HASH_SIZE] = {\n')
+        for i in range(0, len(table), 4):
+            f.write('    ' + ' '.join('%s,' % t for t in table[i:i+4]) + '\n')
+        f.write('};\n')
+    print('%s : %d etiquettes, graine %#x' % (os.path.relpath(DST, ROOT), len(labels), seed))
+
+
+if __name__ == '__main__':
+    main()